@@ -3,8 +3,32 @@
  * @author Dan Oates (WPI Class of 2020)
  */
 #include "BMP180.h"
+#include "BMP180Filter.h"
+#include "BMP180Cache.h"
+#include "BMP180Track.h"
+#include "BMP180Alt.h"
 #include <math.h>
 
+/**
+ * Datasheet Maximum Pressure Conversion Times [us]
+ */
+const uint32_t BMP180::pres_time_max_us[4] = { 4500, 7500, 13500, 25500 };
+
+/**
+ * Pressure Conversion Select Values per Oversampling Setting
+ */
+const uint8_t BMP180::reg_select_oss[4] = { 0x34, 0x74, 0xB4, 0xF4 };
+
+/**
+ * Default Settings
+ */
+const BMP180::settings_t BMP180::settings_default = { NULL, NULL, 0 };
+
+/**
+ * Empty Companion Set
+ */
+const BMP180::companions_t BMP180::companions_none = { NULL, NULL, NULL, NULL, NULL };
+
 /**
  * @brief Constructs BMP180 interface
  * @param i2c Platform-specific I2C bus interface
@@ -12,7 +36,26 @@
 BMP180::BMP180(I2CDevice::i2c_t* i2c) :
 	i2c(i2c, i2c_addr, Struct::msb_first)
 {
+	this->companions = &companions_none;
+	this->cal.ac4 = 0;	// Nonzero once calibration is read
+	this->temp_age = temp_age_none;
+	this->ut = 0;
+	this->up = 0;
+	this->pres_seq = 0;
+#if defined(BMP180_FLOAT_COMP)
+	this->temp = 0.0f;
+#endif
+	this->pres = 0.0f;
 	this->alt_zero = 0.0f;
+#if !defined(BMP180_FLOAT_COMP)
+	this->b5 = 0;
+#endif
+	this->sampling = samples_1x;
+	this->temp_time = temp_time_max_us / time_unit_us;
+	for (uint8_t i = 0; i < 4; i++)
+	{
+		this->pres_time[i] = pres_time_max_us[i] / time_unit_us;
+	}
 }
 
 /**
@@ -29,17 +72,24 @@ bool BMP180::init()
 
 	// Read calibration params
 	i2c.get_seq(reg_cal_addr, 22);
-	ac1 = (int16_t)i2c;
-	ac2 = (int16_t)i2c;
-	ac3 = (int16_t)i2c;
-	ac4 = (uint16_t)i2c;
-	ac5 = (uint16_t)i2c;
-	ac6 = (uint16_t)i2c;
-	b1 = (int16_t)i2c;
-	b2 = (int16_t)i2c;
-	mb = (int16_t)i2c;
-	mc = (int16_t)i2c;
-	md = (int16_t)i2c;
+	cal.ac1 = (int16_t)i2c;
+	cal.ac2 = (int16_t)i2c;
+	cal.ac3 = (int16_t)i2c;
+	cal.ac4 = (uint16_t)i2c;
+	cal.ac5 = (uint16_t)i2c;
+	cal.ac6 = (uint16_t)i2c;
+	cal.b1 = (int16_t)i2c;
+	cal.b2 = (int16_t)i2c;
+	cal.mb = (int16_t)i2c;
+	cal.mc = (int16_t)i2c;
+	cal.md = (int16_t)i2c;
+	temp_age = temp_age_none;
+#if defined(BMP180_FLOAT_COMP)
+	init_fcal(cal, fcal);
+#else
+	BMP180Cache* cache = companions->cache;
+	if (cache) { cache->init(cal); }
+#endif
 
 	// Set sampling to 1x
 	set_sampling(samples_1x);
@@ -60,32 +110,94 @@ bool BMP180::init()
  */
 void BMP180::set_sampling(sampling_t sampling)
 {
-	this->sampling = sampling;
-	switch (sampling)
+	this->sampling = (uint8_t)sampling;
+}
+
+/**
+ * @brief Returns sampling setting of device
+ */
+BMP180::sampling_t BMP180::get_sampling()
+{
+	return (sampling_t)sampling;
+}
+
+/**
+ * @brief Measures conversion times of this particular sensor
+ * @param trials Number of measurements per conversion mode (0 is raised to 1)
+ * 
+ * The datasheet delays are worst cases over all parts. This routine polls
+ * the SCO bit to find the shortest wait after which each conversion mode
+ * (temperature and all oversampling settings) has finished, takes the
+ * worst of the given trials, and stores it with a 1/8 + 250us safety
+ * margin (capped at the datasheet maximum) in 100us units. Later
+ * conversions then use the stored delays with no polling traffic.
+ * 
+ * Call after init(). Takes roughly 0.5 s at the default 4 trials.
+ */
+void BMP180::tune_timing(uint8_t trials)
+{
+	if (trials == 0) { trials = 1; }
+	uint32_t time_us = tune_time(reg_select_temp, temp_time_max_us, trials);
+	temp_time = (time_us + time_unit_us - 1) / time_unit_us;
+	for (uint8_t i = 0; i < 4; i++)
 	{
-		case samples_1x:
-			reg_select_oss = reg_select_oss1;
-			comp_time_us = 4500;
-			oss_shift = 0;
-			break;
-		case samples_2x:
-			reg_select_oss = reg_select_oss2;
-			comp_time_us = 7500;
-			oss_shift = 1;
-			break;
-		case samples_4x:
-			reg_select_oss = reg_select_oss4;
-			comp_time_us = 13500;
-			oss_shift = 2;
-			break;
-		case samples_8x:
-			reg_select_oss = reg_select_oss8;
-			comp_time_us = 25500;
-			oss_shift = 3;
-			break;
+		time_us = tune_time(reg_select_oss[i], pres_time_max_us[i], trials);
+		pres_time[i] = (time_us + time_unit_us - 1) / time_unit_us;
 	}
 }
 
+/**
+ * @brief Sets optional companions and settings
+ * @param companions Companions owned by caller, or NULL for none
+ * 
+ * All companions and rarely-changed settings of a sensor sit behind this
+ * one pointer, so sensors without any pay for a single pointer. Each
+ * companion holds state for one sensor (the cache's pressure terms are
+ * keyed on B5 and OSS only, not on the calibration), so every sensor
+ * needs its own companions_t and companion objects. Only the settings_t
+ * it points to may be shared, e.g. by all sensors of an array. Unused
+ * entries are NULL:
+ * - filter = Spike rejection; outliers are replaced before they reach
+ *   get_pres(), get_alt() and samples
+ * - cache = UT to B5 table and cached pressure terms; without it each
+ *   reading computes all temperature terms and divides by B4, as in the
+ *   datasheet (ignored in float builds, which have no B5 term)
+ * - track = Adapts the age limit of temp_due() to drift and can
+ *   extrapolate temperature to each pressure reading
+ * - alt = Fed each pressure reading for averaged zeroing
+ * - settings = Settings below, or NULL for all defaults
+ * 
+ * Settings entries that are NULL or 0 use their defaults:
+ * - wait = Function waiting for conversions, called with wait_arg (e.g. a
+ *   task, or a sensor when not shared); lets sensors choose their own
+ *   trade-off between latency jitter and CPU use (busy-spin, sleep to an
+ *   absolute deadline, yield to a scheduler). NULL uses
+ *   Platform::wait_us()
+ * - temp_age_max = Age limit of update_stream() and temp_due() in
+ *   pressure samples per temperature reading; 0 uses 50
+ * 
+ * Both structs are read on every conversion, so they must outlive the
+ * sensor. Call again after changing an entry. A cache table is filled
+ * here if init() has already run, or else by init().
+ */
+void BMP180::set_companions(const companions_t* companions)
+{
+	this->companions = (companions != NULL) ? companions : &companions_none;
+#if !defined(BMP180_FLOAT_COMP)
+	BMP180Cache* cache = this->companions->cache;
+	if (cache && cal.ac4 != 0) { cache->init(cal); }
+#endif
+}
+
+/**
+ * @brief Returns attached settings, or the defaults if none
+ */
+const BMP180::settings_t& BMP180::get_settings()
+{
+	const settings_t* settings = companions->settings;
+	return (settings != NULL) ? *settings : settings_default;
+}
+
 /**
  * @brief Updates temperature and pressure readings
  */
@@ -100,20 +212,9 @@ void BMP180::update()
  */
 void BMP180::update_temp()
 {
-	// Read uncompensated temperature
-	i2c.set(reg_select_addr, reg_select_temp);
-	Platform::wait_us(4500);
-	int32_t UT = (int16_t)i2c.get_seq(reg_data_addr, 2);
-
-	// Calibration compensation
-	int32_t x1, x2, T;
-	x1 = ((UT - ac6) * ac5) >> 15;
-	x2 = (mc << 11) / (x1 + md);
-	b5 = x1 + x2;
-	T = (b5 + 8) >> 4;
-
-	// Calculate temperature
-	temp = T * 0.1f;
+	start_temp();
+	wait_us(get_temp_time_us());
+	read_temp();
 }
 
 /**
@@ -122,39 +223,200 @@ void BMP180::update_temp()
  * Uses temperature from last call to update() or update_temp().
  */
 void BMP180::update_pres()
+{
+	start_pres();
+	wait_us(get_pres_time_us());
+	read_pres();
+}
+
+/**
+ * @brief Updates pressure reading, refreshing temperature only when stale
+ * 
+ * Streams pressure conversions with the last temperature, and inserts a
+ * temperature conversion before the pressure conversion when temp_due().
+ * The pressure that follows is then compensated with the fresh
+ * temperature.
+ */
+void BMP180::update_stream()
+{
+	if (temp_due()) { update_temp(); }
+	update_pres();
+}
+
+/**
+ * @brief Returns true if temperature should be refreshed
+ * 
+ * True before the first temperature reading, or once the pressure samples
+ * since the last one reach the current age limit. The limit is the
+ * temp_age_max companion setting, lowered by an attached BMP180Track while
+ * temperature drifts.
+ */
+bool BMP180::temp_due()
+{
+	if (temp_age == temp_age_none) { return true; }
+	BMP180Track* track = companions->track;
+	uint16_t age_max = get_temp_age_max();
+	uint16_t limit = track ? track->get_age_limit(age_max) : age_max;
+	return temp_age >= limit;
+}
+
+/**
+ * @brief Returns temperature age limit from companion settings
+ */
+uint16_t BMP180::get_temp_age_max()
+{
+	uint16_t age_max = get_settings().temp_age_max;
+	return (age_max > 0) ? age_max : temp_age_default;
+}
+
+/**
+ * @brief Fills buffer with back-to-back temperature readings [deg C]
+ * @param buffer Output buffer
+ * @param count Number of readings
+ * 
+ * Runs temperature conversions only, with no pressure conversions in
+ * between. Each conversion is started as soon as the previous result has
+ * been read, before compensating it. The driver has no clock to subtract
+ * that work from the next wait, so readings come every temperature
+ * conversion time (4.5 ms, or less after tune_timing()) plus one I2C read
+ * and one compensation. get_temp() returns the last reading afterwards.
+ */
+void BMP180::update_temp_stream(float* buffer, uint16_t count)
+{
+	if (count == 0) { return; }
+	start_temp();
+	for (uint16_t i = 0; i < count; i++)
+	{
+		wait_us(get_temp_time_us());
+		int32_t UT = get_ut();
+		if (i + 1 < count) { start_temp(); }
+		set_ut(UT);
+		buffer[i] = get_temp();
+	}
+}
+
+/**
+ * @brief Starts temperature conversion
+ * 
+ * Call read_temp() no sooner than get_temp_time_us() later.
+ */
+void BMP180::start_temp()
+{
+	i2c.set(reg_select_addr, reg_select_temp);
+}
+
+/**
+ * @brief Reads and compensates finished temperature conversion
+ */
+void BMP180::read_temp()
+{
+	set_ut(get_ut());
+}
+
+/**
+ * @brief Reads finished temperature conversion
+ * @return Uncompensated temperature UT
+ */
+int32_t BMP180::get_ut()
+{
+	return (uint16_t)i2c.get_seq(reg_data_addr, 2);
+}
+
+/**
+ * @brief Compensates uncompensated temperature reading
+ * @param UT Uncompensated temperature
+ */
+void BMP180::set_ut(int32_t UT)
+{
+	// Calculate temperature (skipped for unchanged reading)
+	BMP180Track* track = companions->track;
+	bool first = (temp_age == temp_age_none);
+#if defined(BMP180_FLOAT_COMP)
+	float temp_prev = temp;
+	if (first || UT != ut) { temp = comp_temp_float(fcal, UT); }
+#else
+	int32_t b5_prev = b5;
+	if (first || UT != ut)
+	{
+		BMP180Cache* cache = companions->cache;
+		b5 = cache ? cache->comp_b5(cal, UT) : comp_b5(cal, UT);
+	}
+#endif
+
+	// Update drift tracker
+	if (track)
+	{
+		uint16_t age = first ? 0 : temp_age;
+#if defined(BMP180_FLOAT_COMP)
+		int32_t b5_delta = (int32_t)lroundf((temp - temp_prev) * BMP180Track::b5_per_deg);
+#else
+		int32_t b5_delta = b5 - b5_prev;
+#endif
+		track->update(UT - (int32_t)ut, b5_delta, age, get_temp_age_max());
+	}
+	ut = (uint16_t)UT;
+	temp_age = 0;
+}
+
+/**
+ * @brief Starts pressure conversion
+ * 
+ * Call read_pres() no sooner than get_pres_time_us() later.
+ */
+void BMP180::start_pres()
+{
+	i2c.set(reg_select_addr, reg_select_oss[sampling]);
+}
+
+/**
+ * @brief Reads and compensates finished pressure conversion
+ * 
+ * Uses temperature from last call to update(), update_temp() or read_temp().
+ */
+void BMP180::read_pres()
 {
 	// Read uncompensated pressure
-	i2c.set(reg_select_addr, reg_select_oss);
-	Platform::wait_us(comp_time_us);
 	i2c.get_seq(reg_data_addr, 3);
-	uint32_t msb = (uint8_t)i2c;
-	uint32_t lsb = (uint8_t)i2c;
+	uint32_t msw = (uint16_t)i2c;
 	uint32_t xlsb = (uint8_t)i2c;
-	uint32_t UP = ((msb << 16) + (lsb << 8) + xlsb) >> (8 - oss_shift);
-
-	// Calibration compensation
-	int32_t b6, x1, x2 ,x3, b3, p;
-	uint32_t b4, b7;
-	b6 = b5 - 4000;
-	x1 = (b2 * ((b6 * b6) >> 12)) >> 11;
-	x2 = (ac2 * b6) >> 11;
-	x3 = x1 + x2;
-	b3 = ((((ac1 << 2) + x3) << oss_shift) + 2) >> 2;
-	x1 = (ac3 * b6) >> 13;
-	x2 = (b1 * ((b6 * b6) >> 12)) >> 16;
-	x3 = ((x1 + x2) + 2) >> 2;
-	b4 = (ac4 * (uint32_t)(x3 + 32768)) >> 15;
-	b7 = (UP - b3) * (uint32_t)(50000 >> oss_shift);
-	if (b7 < 0x80000000) { p = (b7 << 1) / b4; }
-	else { p = (b7 / b4) << 1; }
-	x1 = p >> 8;
-	x1 = x1 * x1;
-	x1 = (x1 * 3038) >> 16;
-	x2 = (-7357 * p) >> 16;
-	p = p + ((x1 + x2 + 3791) >> 4);
+	uint8_t oss = sampling;
+	uint32_t UP = ((msw << 8) | xlsb) >> (8 - oss);
+	up = UP;
 
 	// Calculate pressure
-	pres = p * 0.001f;
+	BMP180Track* track = companions->track;
+	uint16_t age = (temp_age != temp_age_none) ? temp_age : 0;
+#if defined(BMP180_FLOAT_COMP)
+	float T = temp;
+	if (track) { T += track->get_temp_offset(age); }
+	pres = comp_pres_float(fcal, T, UP, oss);
+#else
+	int32_t B5 = b5;
+	if (track) { B5 += track->get_b5_offset(age); }
+	BMP180Cache* cache = companions->cache;
+	int32_t P = cache ? cache->comp_pres(cal, B5, UP, oss) : comp_pres(cal, B5, UP, oss);
+	pres = P * 0.001f;
+#endif
+	if (companions->filter) { pres = companions->filter->apply(pres); }
+	if (temp_age < temp_age_none - 1) { temp_age++; }
+	pres_seq++;
+	if (companions->alt) { companions->alt->feed(); }
+}
+
+/**
+ * @brief Returns temperature conversion time [us]
+ */
+uint32_t BMP180::get_temp_time_us()
+{
+	return temp_time * time_unit_us;
+}
+
+/**
+ * @brief Returns pressure conversion time at current sampling [us]
+ */
+uint32_t BMP180::get_pres_time_us()
+{
+	return pres_time[sampling] * time_unit_us;
 }
 
 /**
@@ -164,7 +426,11 @@ void BMP180::update_pres()
  */
 float BMP180::get_temp()
 {
+#if defined(BMP180_FLOAT_COMP)
 	return temp;
+#else
+	return comp_temp(b5) * 0.1f;
+#endif
 }
 
 /**
@@ -178,13 +444,35 @@ float BMP180::get_pres()
 }
 
 /**
- * @brief Returns altitude above sea-level [m]
+ * @brief Returns latest temperature and pressure as one record
+ * 
+ * The sequence number increments on every pressure reading.
+ */
+BMP180::sample_t BMP180::get_sample()
+{
+	sample_t sample;
+	sample.seq = pres_seq;
+	sample.temp = get_temp();
+	sample.pres = pres;
+	sample.ut = ut;
+	sample.up = up;
+	return sample;
+}
+
+/**
+ * @brief Returns altitude relative to zero position [m]
  * @param sea_level_p Sea-level pressure [kPa]
  * 
- * Uses pressure from last call to update() or update_pres().
+ * Uses pressure from last call to update() or update_pres(). With an
+ * altitude companion attached this is BMP180Alt::get_alt(), which caches
+ * the powf() and is relative to the companion's zero, as set by
+ * zero_alt() or BMP180Alt::zero_alt_start(). Otherwise it is relative to
+ * the sensor's own zero from zero_alt() (0 until then).
  */
 float BMP180::get_alt(float sea_level_p)
 {
+	BMP180Alt* alt_comp = companions->alt;
+	if (alt_comp) { return alt_comp->get_alt(sea_level_p); }
 	float alt = 44330.0f * (1.0f - powf(pres / sea_level_p, 0.190295f));
 	return alt - alt_zero;
 }
@@ -192,9 +480,361 @@ float BMP180::get_alt(float sea_level_p)
 /**
  * @brief Sets current altitude to zero position
  * @param sea_level_p Sea-level pressure [kPa]
+ * 
+ * Sets the altitude companion's zero if one is attached, or else the
+ * sensor's own zero. get_alt() always reads the same one.
  */
 void BMP180::zero_alt(float sea_level_p)
 {
+	BMP180Alt* alt_comp = companions->alt;
+	if (alt_comp)
+	{
+		alt_comp->zero_alt(sea_level_p);
+		return;
+	}
 	update();
+	alt_zero = 0.0f;
 	alt_zero = get_alt(sea_level_p);
 }
+
+/**
+ * @brief Waits for conversion with companion wait function
+ * @param us Wait time [us]
+ */
+void BMP180::wait_us(uint32_t us)
+{
+	const settings_t& settings = get_settings();
+	if (settings.wait)
+	{
+		settings.wait(settings.wait_arg, us);
+		return;
+	}
+
+	// Arduino delayMicroseconds() is only accurate up to 16383us
+	while (us > wait_chunk_us)
+	{
+		Platform::wait_us(wait_chunk_us);
+		us -= wait_chunk_us;
+	}
+	Platform::wait_us(us);
+}
+
+/**
+ * @brief Measures conversion time for one mode
+ * @param reg_select Conversion select register value
+ * @param time_max_us Datasheet maximum conversion time [us]
+ * @param trials Number of measurements
+ * @return Conversion delay with safety margin [us]
+ * 
+ * Returns time_max_us if the conversion never finishes within it.
+ */
+uint32_t BMP180::tune_time(uint8_t reg_select, uint32_t time_max_us, uint8_t trials)
+{
+	// Search upwards from half the datasheet maximum
+	uint32_t time_us = time_max_us / 2;
+	for (uint8_t i = 0; i < trials; i++)
+	{
+		while (true)
+		{
+			// Start conversion and check SCO after candidate delay
+			i2c.set(reg_select_addr, reg_select);
+			wait_us(time_us);
+			bool done = conversion_done();
+
+			// Let conversion finish before next one
+			uint32_t settle_us = 0;
+			while (!conversion_done())
+			{
+				if (settle_us >= time_max_us) { return time_max_us; }
+				wait_us(tune_step_us);
+				settle_us += tune_step_us;
+			}
+
+			// Lengthen delay until conversion is done in time
+			if (done) { break; }
+			time_us += tune_step_us;
+			if (time_us >= time_max_us) { return time_max_us; }
+		}
+	}
+
+	// Add safety margin
+	time_us += (time_us >> 3) + tune_step_us;
+	return (time_us < time_max_us) ? time_us : time_max_us;
+}
+
+/**
+ * @brief Returns true if SCO bit indicates conversion is complete
+ */
+bool BMP180::conversion_done()
+{
+	return ((uint8_t)i2c.get_seq(reg_select_addr, 1) & reg_select_sco) == 0;
+}
+
+/**
+ * @brief Returns calibration coefficients read by init()
+ */
+const BMP180::cal_t& BMP180::get_cal()
+{
+	return cal;
+}
+
+/**
+ * @brief Computes temperature compensation term B5
+ * @param cal Calibration coefficients
+ * @param ut Uncompensated temperature
+ * 
+ * All kernel constants and operands are fixed-width, so 16-bit int targets
+ * (AVR) promote exactly like 32 and 64-bit ones and give identical results.
+ * The 16-bit coefficients are widened to 32 bits as they are loaded.
+ * A glitched UT that would divide by zero is nudged off the singularity.
+ */
+int32_t BMP180::comp_b5(const cal_t& cal, int32_t ut)
+{
+	int32_t x1, x2, d;
+	x1 = ((ut - (int32_t)cal.ac6) * (int32_t)cal.ac5) >> 15;
+	d = x1 + (int32_t)cal.md;
+	if (d == 0) { d = 1; }
+	x2 = ((int32_t)cal.mc * (int32_t)2048) / d;
+	return x1 + x2;
+}
+
+/**
+ * @brief Computes temperature [0.1 deg C] from B5
+ * @param b5 Temperature compensation term
+ */
+int32_t BMP180::comp_temp(int32_t b5)
+{
+	return (b5 + 8) >> 4;
+}
+
+/**
+ * @brief Computes pressure offset term B3
+ * @param cal Calibration coefficients
+ * @param b5 Temperature compensation term
+ * @param oss Oversampling setting (0-3)
+ */
+int32_t BMP180::comp_b3(const cal_t& cal, int32_t b5, uint8_t oss)
+{
+	int32_t b6, x1, x2, x3;
+	b6 = b5 - (int32_t)4000;
+	x1 = ((int32_t)cal.b2 * ((b6 * b6) >> 12)) >> 11;
+	x2 = ((int32_t)cal.ac2 * b6) >> 11;
+	x3 = x1 + x2;
+
+	// Shift in unsigned: defined for negative terms and no variable multiply
+	int32_t y = (int32_t)((uint32_t)((int32_t)cal.ac1 * (int32_t)4 + x3) << oss);
+	return (y + (int32_t)2) >> 2;
+}
+
+/**
+ * @brief Computes pressure scale term B4
+ * @param cal Calibration coefficients
+ * @param b5 Temperature compensation term
+ */
+uint32_t BMP180::comp_b4(const cal_t& cal, int32_t b5)
+{
+	int32_t b6, x1, x2, x3;
+	b6 = b5 - (int32_t)4000;
+	x1 = ((int32_t)cal.ac3 * b6) >> 13;
+	x2 = ((int32_t)cal.b1 * ((b6 * b6) >> 12)) >> 16;
+	x3 = ((x1 + x2) + (int32_t)2) >> 2;
+	return ((uint32_t)cal.ac4 * (uint32_t)(x3 + (int32_t)32768)) >> 15;
+}
+
+/**
+ * @brief Computes fixed-point reciprocal of B4 for comp_pres()
+ * @param b4 Pressure scale term
+ * @return floor((2^32 - 1) / b4)
+ */
+uint32_t BMP180::comp_b4_inv(uint32_t b4)
+{
+	return (uint32_t)0xFFFFFFFF / b4;
+}
+
+/**
+ * @brief Computes pressure [Pa]
+ * @param cal Calibration coefficients
+ * @param b5 Temperature compensation term
+ * @param up Uncompensated pressure
+ * @param oss Oversampling setting (0-3)
+ */
+int32_t BMP180::comp_pres(const cal_t& cal, int32_t b5, uint32_t up, uint8_t oss)
+{
+	return comp_pres(comp_b3(cal, b5, oss), comp_b4(cal, b5), up, oss);
+}
+
+/**
+ * @brief Computes pressure [Pa] from precomputed temperature terms
+ * @param b3 Pressure offset term from comp_b3()
+ * @param b4 Pressure scale term from comp_b4()
+ * @param up Uncompensated pressure
+ * @param oss Oversampling setting (0-3)
+ * 
+ * Divides by B4 once, as in the datasheet. Cheapest for a single reading
+ * per B4.
+ */
+int32_t BMP180::comp_pres(int32_t b3, uint32_t b4, uint32_t up, uint8_t oss)
+{
+	uint32_t b7 = (up - (uint32_t)b3) * ((uint32_t)50000 >> oss);
+	uint32_t p = (b7 < (uint32_t)0x80000000) ? ((b7 << 1) / b4) : ((b7 / b4) << 1);
+	return comp_pres_poly((int32_t)p);
+}
+
+/**
+ * @brief Computes pressure [Pa] from precomputed temperature terms
+ * @param b3 Pressure offset term from comp_b3()
+ * @param b4 Pressure scale term from comp_b4()
+ * @param b4_inv Reciprocal of B4 from comp_b4_inv()
+ * @param up Uncompensated pressure
+ * @param oss Oversampling setting (0-3)
+ * 
+ * Replaces the datasheet divisions by B4 with a multiply by the reciprocal
+ * and at most one correction step, giving bit-identical quotients. Only
+ * pays off when several readings share B4, since the reciprocal itself
+ * costs a division.
+ */
+int32_t BMP180::comp_pres(int32_t b3, uint32_t b4, uint32_t b4_inv, uint32_t up, uint8_t oss)
+{
+	uint32_t b7, n, q;
+	b7 = (up - (uint32_t)b3) * ((uint32_t)50000 >> oss);
+	n = (b7 < (uint32_t)0x80000000) ? (b7 << 1) : b7;
+	q = (uint32_t)(((uint64_t)n * b4_inv) >> 32);
+	if (n - q * b4 >= b4) { q++; }
+	return comp_pres_poly((int32_t)((b7 < (uint32_t)0x80000000) ? q : (q << 1)));
+}
+
+/**
+ * @brief Applies final pressure correction polynomial [Pa]
+ * @param p Uncorrected pressure [Pa]
+ */
+int32_t BMP180::comp_pres_poly(int32_t p)
+{
+	int32_t x1, x2;
+	x1 = p >> 8;
+	x1 = x1 * x1;
+	x1 = (x1 * (int32_t)3038) >> 16;
+	x2 = ((int32_t)-7357 * p) >> 16;
+	return p + ((x1 + x2 + (int32_t)3791) >> 4);
+}
+
+/**
+ * @brief Finds uncompensated temperature for a temperature
+ * @param cal Calibration coefficients
+ * @param t Temperature [0.1 deg C]
+ * @return Smallest UT reading as t (clamped to the valid UT range)
+ * 
+ * Binary search over the UT codes above the singularity of the B5 divisor
+ * (X1 + MD > 0), where the forward path is monotonic. This reaches below
+ * AC6, which is where typical parts read about -39 deg C.
+ */
+int32_t BMP180::inv_temp(const cal_t& cal, int32_t t)
+{
+	// Find first UT above singularity
+	int32_t lo = 0;
+	int32_t hi = cal.ac6;
+	while (lo < hi)
+	{
+		int32_t mid = (lo + hi) >> 1;
+		int32_t x1 = ((mid - (int32_t)cal.ac6) * (int32_t)cal.ac5) >> 15;
+		if (x1 + (int32_t)cal.md <= 0) { lo = mid + 1; }
+		else { hi = mid; }
+	}
+
+	// Search for temperature
+	hi = 0xFFFF;
+	while (lo < hi)
+	{
+		int32_t mid = (lo + hi) >> 1;
+		if (comp_temp(comp_b5(cal, mid)) < t) { lo = mid + 1; }
+		else { hi = mid; }
+	}
+	return lo;
+}
+
+/**
+ * @brief Finds uncompensated pressure for a pressure
+ * @param cal Calibration coefficients
+ * @param b5 Temperature compensation term
+ * @param p Pressure [Pa]
+ * @param oss Oversampling setting (0-3)
+ * @return Smallest UP reading as p (clamped to the valid UP range)
+ * 
+ * Binary search over UP >= B3, where the forward path is monotonic.
+ */
+uint32_t BMP180::inv_pres(const cal_t& cal, int32_t b5, int32_t p, uint8_t oss)
+{
+	int32_t b3 = comp_b3(cal, b5, oss);
+	uint32_t lo = (b3 > 0) ? b3 : 0;
+	uint32_t hi = (0x10000UL << oss) - 1;
+	while (lo < hi)
+	{
+		uint32_t mid = (lo + hi) >> 1;
+		if (comp_pres(cal, b5, mid, oss) < p) { lo = mid + 1; }
+		else { hi = mid; }
+	}
+	return lo;
+}
+
+/**
+ * @brief Converts calibration to float compensation coefficients
+ * @param cal Calibration coefficients
+ * @param fcal Output float coefficients
+ * 
+ * Coefficients of the polynomial form of the Bosch algorithm, with the
+ * integer scale factors folded in so each sample costs one divide and a
+ * few multiply-adds.
+ */
+void BMP180::init_fcal(const cal_t& cal, fcal_t& fcal)
+{
+	float c3 = 160.0f * ldexpf(1.0f, -15) * cal.ac3;
+	float c4 = 1e-3f * ldexpf(1.0f, -15) * cal.ac4;
+	float b1 = 25600.0f * ldexpf(1.0f, -30) * cal.b1;
+	fcal.c5 = (ldexpf(1.0f, -15) / 160.0f) * cal.ac5;
+	fcal.c6 = (float)cal.ac6;
+	fcal.mc = (2048.0f / 25600.0f) * cal.mc;
+	fcal.md = cal.md / 160.0f;
+	fcal.x0 = (float)cal.ac1;
+	fcal.x1 = 160.0f * ldexpf(1.0f, -13) * cal.ac2;
+	fcal.x2 = 25600.0f * ldexpf(1.0f, -25) * cal.b2;
+	fcal.y0 = c4 * 32768.0f;
+	fcal.y1 = c4 * c3;
+	fcal.y2 = c4 * b1;
+	fcal.p0 = (3791.0f - 8.0f) / 16000.0f;
+	fcal.p1 = (1.0f - 7357.0f * ldexpf(1.0f, -20)) * 0.1f;
+	fcal.p2 = 3038.0f * 10.0f * ldexpf(1.0f, -36);
+}
+
+/**
+ * @brief Computes temperature with float compensation [deg C]
+ * @param fcal Float coefficients
+ * @param ut Uncompensated temperature
+ */
+float BMP180::comp_temp_float(const fcal_t& fcal, int32_t ut)
+{
+	float a = fcal.c5 * (ut - fcal.c6);
+	return a + fcal.mc / (a + fcal.md);
+}
+
+/**
+ * @brief Computes pressure with float compensation [kPa]
+ * @param fcal Float coefficients
+ * @param temp Temperature [deg C]
+ * @param up Uncompensated pressure
+ * @param oss Oversampling setting (0-3)
+ * 
+ * Compared with the integer kernel over 30-110 kPa and -40 to 85 deg C at
+ * every oversampling setting, with every UT and UP code in that range:
+ * the datasheet calibration stays within 9.6 Pa, and temperature within
+ * 0.063 deg C. Calibrations within 25% of it reached 11.3 Pa (on every
+ * 16th UP code), so allow about 12 Pa for other parts, against 3-6 Pa
+ * RMS sensor noise. BMP180CheckTool reports the bound for a given
+ * calibration.
+ */
+float BMP180::comp_pres_float(const fcal_t& fcal, float temp, uint32_t up, uint8_t oss)
+{
+	float s = temp - 25.0f;
+	float x = (fcal.x2 * s + fcal.x1) * s + fcal.x0;
+	float y = (fcal.y2 * s + fcal.y1) * s + fcal.y0;
+	float z = (ldexpf((float)up, -oss) - x) / y;
+	return (fcal.p2 * z + fcal.p1) * z + fcal.p0;
+}
@@ -4,6 +4,7 @@
  * @author Dan Oates (WPI Class of 2020)
  */
 #pragma once
+#include "BMP180Config.h"
 #include <I2CDevice.h>
 
 /**
@@ -13,6 +14,14 @@
 	#error BMP180 requires I2CDEVICE_BUFFER_SIZE >= 22
 #endif
 
+/**
+ * Forward Declarations
+ */
+class BMP180Filter;
+class BMP180Cache;
+class BMP180Track;
+class BMP180Alt;
+
 /**
  * Class Declaration
  */
@@ -30,22 +39,107 @@ public:
 	}
 	sampling_t;
 
+	// Sample record
+	typedef struct
+	{
+		uint32_t seq;	// Pressure sample sequence number
+		float temp;	// Temperature [deg C]
+		float pres;	// Pressure [kPa]
+		int32_t ut;	// Uncompensated temperature
+		uint32_t up;	// Uncompensated pressure
+	}
+	sample_t;
+
+	// Calibration coefficients (EEPROM width)
+	typedef struct
+	{
+		int16_t ac1, ac2, ac3;
+		uint16_t ac4, ac5, ac6;
+		int16_t b1, b2;
+		int16_t mb, mc, md;
+	}
+	cal_t;
+
+	// Float calibration coefficients
+	typedef struct
+	{
+		float c5, c6, mc, md;
+		float x0, x1, x2;
+		float y0, y1, y2;
+		float p0, p1, p2;
+	}
+	fcal_t;
+
+	// Wait function [us] with caller context
+	typedef void (*wait_t)(void* arg, uint32_t us);
+
+	// Settings, shareable between sensors (NULL or 0 entries use defaults)
+	typedef struct
+	{
+		wait_t wait;		// Conversion wait (Platform::wait_us())
+		void* wait_arg;		// Context passed to wait
+		uint16_t temp_age_max;	// Pressure samples per temperature (50)
+	}
+	settings_t;
+
+	// Optional companions of one sensor (NULL entries disabled)
+	typedef struct
+	{
+		BMP180Filter* filter;		// Spike rejection of each pressure reading
+		BMP180Cache* cache;		// Compensation caches (integer builds)
+		BMP180Track* track;		// Temperature drift tracking
+		BMP180Alt* alt;			// Altitude and zero behind get_alt()
+		const settings_t* settings;	// Settings (NULL for defaults)
+	}
+	companions_t;
+
 	// Constructor and basics
 	BMP180(I2CDevice::i2c_t* i2c);
 	bool init();
 	void set_sampling(sampling_t sampling);
+	sampling_t get_sampling();
+	void tune_timing(uint8_t trials = 4);
+	void set_companions(const companions_t* companions);
 
 	// Measurements
 	void update();
 	void update_temp();
 	void update_pres();
+	void update_stream();
+	void update_temp_stream(float* buffer, uint16_t count);
+	bool temp_due();
 	float get_temp();
 	float get_pres();
+	sample_t get_sample();
 	float get_alt(float sea_level_p = 101.325f);
+
+	// Non-blocking conversion steps
+	void start_temp();
+	void read_temp();
+	void start_pres();
+	void read_pres();
+	uint32_t get_temp_time_us();
+	uint32_t get_pres_time_us();
 	
 	// Altitude calibration
 	void zero_alt(float sea_level_p = 101.325f);
 
+	// Compensation kernel
+	const cal_t& get_cal();
+	static int32_t comp_b5(const cal_t& cal, int32_t ut);
+	static int32_t comp_temp(int32_t b5);
+	static int32_t comp_b3(const cal_t& cal, int32_t b5, uint8_t oss);
+	static uint32_t comp_b4(const cal_t& cal, int32_t b5);
+	static uint32_t comp_b4_inv(uint32_t b4);
+	static int32_t comp_pres(const cal_t& cal, int32_t b5, uint32_t up, uint8_t oss);
+	static int32_t comp_pres(int32_t b3, uint32_t b4, uint32_t up, uint8_t oss);
+	static int32_t comp_pres(int32_t b3, uint32_t b4, uint32_t b4_inv, uint32_t up, uint8_t oss);
+	static int32_t inv_temp(const cal_t& cal, int32_t t);
+	static uint32_t inv_pres(const cal_t& cal, int32_t b5, int32_t p, uint8_t oss);
+	static void init_fcal(const cal_t& cal, fcal_t& fcal);
+	static float comp_temp_float(const fcal_t& fcal, int32_t ut);
+	static float comp_pres_float(const fcal_t& fcal, float temp, uint32_t up, uint8_t oss);
+
 protected:
 
 	// I2C Communication
@@ -58,25 +152,58 @@ protected:
 	static const uint8_t reg_id_val = 0x55;
 	static const uint8_t reg_select_addr = 0xF4;
 	static const uint8_t reg_select_temp = 0x2E;
-	static const uint8_t reg_select_oss1 = 0x34;
-	static const uint8_t reg_select_oss2 = 0x74;
-	static const uint8_t reg_select_oss4 = 0xB4;
-	static const uint8_t reg_select_oss8 = 0xF4;
+	static const uint8_t reg_select_oss[4];
+	static const uint8_t reg_select_sco = 0x20;
 	static const uint8_t reg_data_addr = 0xF6;
 
-	// Oversampling Parameters
-	uint8_t reg_select_oss;
-	uint32_t comp_time_us;
-	uint8_t oss_shift;
-	sampling_t sampling;
+	// Conversion Timing
+	static const uint32_t temp_time_max_us = 4500;
+	static const uint32_t pres_time_max_us[4];
+	static const uint32_t tune_step_us = 250;
+	static const uint32_t time_unit_us = 100;
+	uint8_t temp_time;
+	uint8_t pres_time[4];
+	uint32_t tune_time(uint8_t reg_select, uint32_t time_max_us, uint8_t trials);
+	bool conversion_done();
+
+	// Oversampling setting (index into shared tables)
+	uint8_t sampling;
 
 	// Calibration Parameters
-	int32_t ac1, ac2, ac3;
-	uint32_t ac4, ac5, ac6;
-	int32_t b1, b2;
-	int32_t mb, mc, md;
+	cal_t cal;
+#if defined(BMP180_FLOAT_COMP)
+	fcal_t fcal;
+#else
+	int32_t b5;
+#endif
+
+	// Wait function
+	static const uint32_t wait_chunk_us = 16000;
+	void wait_us(uint32_t us);
+
+	// Optional companions
+	static const settings_t settings_default;
+	static const companions_t companions_none;
+	const companions_t* companions;
+	const settings_t& get_settings();
+
+	// Compensation helpers
+	static int32_t comp_pres_poly(int32_t p);
+	int32_t get_ut();
+	void set_ut(int32_t UT);
+
+	// Temperature age [pressure samples]
+	static const uint16_t temp_age_none = 0xFFFF;
+	static const uint16_t temp_age_default = 50;
+	uint16_t temp_age;
+	uint16_t get_temp_age_max();
 
 	// State data
-	int32_t b5;
-	float temp, pres, alt_zero;
+	uint16_t ut;
+	uint32_t up;
+	uint32_t pres_seq;
+#if defined(BMP180_FLOAT_COMP)
+	float temp;
+#endif
+	float pres, alt_zero;
 };
@@ -0,0 +1,117 @@
+/**
+ * @file BMP180Adapt.cpp
+ */
+#include "BMP180Adapt.h"
+#include <math.h>
+
+/**
+ * Datasheet RMS Pressure Noise per Sampling Setting [Pa]
+ */
+static const float noise_rms_pa[4] = { 6.0f, 5.0f, 4.0f, 3.0f };
+
+/**
+ * @brief Constructs adaptive oversampling controller
+ * @param bmp BMP180 to control (must already be initialized)
+ * @param target_pa Target RMS pressure noise [Pa]
+ * @param window Pressure samples per decision
+ */
+BMP180Adapt::BMP180Adapt(BMP180* bmp, float target_pa, uint16_t window)
+{
+	this->bmp = bmp;
+	this->target_pa = target_pa;
+	this->window = (window > 2) ? window : 2;
+	this->have_last = false;
+	this->count = 0;
+	this->mean = 0.0f;
+	this->m2 = 0.0f;
+	this->noise_var = 0.0f;
+	this->noise_pa = 0.0f;
+	this->windows = 0;
+	this->changes = 0;
+}
+
+/**
+ * @brief Feeds latest pressure reading and adapts sampling
+ * 
+ * Call once after each new pressure reading. Noise is estimated from the
+ * variance of successive differences (2 sigma^2 for white noise), which
+ * ignores slow pressure trends. Window variances are smoothed while the
+ * setting is unchanged. From the second window at a setting on, sampling
+ * steps up if noise exceeds the target, or down if the next-lower setting
+ * is predicted (by datasheet noise ratios) to stay below 85% of it.
+ */
+void BMP180Adapt::update()
+{
+	// Accumulate successive differences
+	float p_pa = bmp->get_pres() * 1000.0f;
+	if (!have_last)
+	{
+		last_pa = p_pa;
+		have_last = true;
+		return;
+	}
+	float x = p_pa - last_pa;
+	last_pa = p_pa;
+	count++;
+	float d = x - mean;
+	mean += d / count;
+	m2 += d * (x - mean);
+	if (count < window)
+	{
+		return;
+	}
+
+	// Smooth noise variance over windows at this setting
+	float var = m2 / (2.0f * (count - 1));
+	count = 0;
+	mean = 0.0f;
+	m2 = 0.0f;
+	have_last = false;
+	noise_var = (windows == 0) ? var : noise_var + (var - noise_var) * 0.25f;
+	noise_pa = sqrtf(noise_var);
+	if (windows < 2) { windows++; }
+	if (windows < 2) { return; }
+
+	// Step sampling toward target
+	uint8_t s = bmp->get_sampling();
+	if (noise_pa > target_pa && s < BMP180::samples_8x)
+	{
+		s++;
+	}
+	else if (s > BMP180::samples_1x &&
+		noise_pa * noise_rms_pa[s - 1] / noise_rms_pa[s] < 0.85f * target_pa)
+	{
+		s--;
+	}
+	else
+	{
+		return;
+	}
+	bmp->set_sampling((BMP180::sampling_t)s);
+	windows = 0;
+	changes++;
+}
+
+/**
+ * @brief Returns RMS pressure noise measured over last window [Pa]
+ */
+float BMP180Adapt::get_noise_pa()
+{
+	return noise_pa;
+}
+
+/**
+ * @brief Returns current sampling setting
+ */
+BMP180::sampling_t BMP180Adapt::get_sampling()
+{
+	return bmp->get_sampling();
+}
+
+/**
+ * @brief Returns number of sampling changes made
+ */
+uint32_t BMP180Adapt::get_changes()
+{
+	return changes;
+}
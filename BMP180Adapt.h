@@ -0,0 +1,44 @@
+/**
+ * @file BMP180Adapt.h
+ * @brief Noise-driven oversampling selection for BMP180
+ */
+#pragma once
+#include "BMP180.h"
+
+/**
+ * Class Declaration
+ */
+class BMP180Adapt
+{
+public:
+
+	// Constructor and basics
+	BMP180Adapt(BMP180* bmp, float target_pa, uint16_t window = 64);
+	void update();
+
+	// Metrics
+	float get_noise_pa();
+	BMP180::sampling_t get_sampling();
+	uint32_t get_changes();
+
+protected:
+
+	// Sensor and target
+	BMP180* bmp;
+	float target_pa;
+	uint16_t window;
+
+	// Welford accumulator of successive differences
+	bool have_last;
+	float last_pa;
+	uint16_t count;
+	float mean, m2;
+
+	// Smoothed estimate
+	uint16_t windows;
+	float noise_var;
+
+	// Metrics
+	float noise_pa;
+	uint32_t changes;
+};
@@ -0,0 +1,302 @@
+/**
+ * @file BMP180Alt.cpp
+ */
+#include "BMP180Alt.h"
+#include <math.h>
+
+/**
+ * Memory barrier for data shared with the sampling thread
+ */
+#define BMP180ALT_BARRIER() __sync_synchronize()
+
+/**
+ * Minimum Zeroing Variance [kPa^2]
+ */
+const float BMP180Alt::zero_var_min = 1e-6f;
+
+/**
+ * @brief Sorts a few values in place by insertion
+ * @param x Values
+ * @param n Number of values
+ */
+static void sort(float* x, uint8_t n)
+{
+	for (uint8_t i = 1; i < n; i++)
+	{
+		float v = x[i];
+		uint8_t j = i;
+		for (; j > 0 && x[j - 1] > v; j--) { x[j] = x[j - 1]; }
+		x[j] = v;
+	}
+}
+
+/**
+ * @brief Constructs altitude tracker
+ * @param bmp BMP180 to read pressure from
+ * 
+ * Adds a cached altitude, a powf-free relative altitude and averaged
+ * zeroing on top of the sensor. Attach as the alt entry of
+ * bmp->set_companions() for zero_alt_start(), which needs every pressure
+ * reading. Once attached, the sensor's get_alt() and zero_alt() forward
+ * here, so both share this one zero position.
+ */
+BMP180Alt::BMP180Alt(BMP180* bmp)
+{
+	this->bmp = bmp;
+	this->alt_pres = -1.0f;
+	this->alt_sea_level_p = 0.0f;
+	this->alt_abs = 0.0f;
+	this->zero.alt = 0.0f;
+	this->zero.pres = 0.0f;
+	this->zero.c1 = 0.0f;
+	this->zero.c2 = 0.0f;
+	this->zero_lock = 0;
+	this->zero_req_samples = 0;
+	this->zero_req_sea_level_p = 0.0f;
+	this->zero_req_gen = 0;
+	this->zero_gen = 0;
+	this->zero_target = 0;
+}
+
+/**
+ * @brief Feeds latest pressure reading to averaged zeroing
+ * 
+ * Called by the attached BMP180 after each pressure reading. Picks up a
+ * new zero_alt_start() request and resets the running mean itself, so only
+ * this sampling context writes the accumulator and zero_target. The first
+ * zero_seed readings are held back and seed the running mean about their
+ * median (see seed_zero()), so an early spike cannot widen the gate. Later
+ * readings more than 3 standard deviations from the running mean are
+ * skipped.
+ */
+void BMP180Alt::feed()
+{
+	// Take new request, retrying next reading if it changes during the copy
+	uint8_t gen = zero_req_gen;
+	if (gen != zero_gen)
+	{
+		BMP180ALT_BARRIER();
+		uint16_t samples = zero_req_samples;
+		float sea_level_p = zero_req_sea_level_p;
+		BMP180ALT_BARRIER();
+		if (gen != zero_req_gen) { return; }
+		zero_count = 0;
+		zero_seen = 0;
+		zero_mean = 0.0f;
+		zero_m2 = 0.0f;
+		zero_var_seed = 0.0f;
+		zero_sea_level_p = sea_level_p;
+		zero_target = samples;
+		BMP180ALT_BARRIER();
+		zero_gen = gen;
+	}
+	uint16_t target = zero_target;
+	if (target == 0) { return; }
+	float pres = bmp->get_pres();
+	zero_seen++;
+
+	// Hold first readings until gate can be seeded
+	uint8_t n = (target < zero_seed) ? (uint8_t)target : zero_seed;
+	if (zero_seen <= n)
+	{
+		zero_seed_p[zero_seen - 1] = pres;
+		if (zero_seen < n) { return; }
+		seed_zero(n);
+	}
+	else
+	{
+		// Seed spread until sample spread is known
+		float var = zero_var_seed;
+		if (zero_count >= 4) { var = zero_m2 / (zero_count - 1); }
+
+		// Floor spread at one output LSB (1 Pa) for quantized readings
+		if (var < zero_var_min) { var = zero_var_min; }
+		float d = pres - zero_mean;
+		if ((d * d) <= 9.0f * var)
+		{
+			// Welford update
+			zero_count++;
+			zero_mean += d / zero_count;
+			zero_m2 += d * (pres - zero_mean);
+		}
+	}
+
+	// Commit zero when complete
+	if (zero_count >= target || zero_seen >= 4 * (uint32_t)target)
+	{
+		set_zero(zero_mean, zero_sea_level_p);
+		zero_target = 0;
+	}
+}
+
+/**
+ * @brief Returns altitude relative to zero position [m]
+ * @param sea_level_p Sea-level pressure [kPa]
+ * 
+ * The altitude above sea-level is cached until the pressure or sea_level_p
+ * changes, so repeated calls between readings skip the powf().
+ */
+float BMP180Alt::get_alt(float sea_level_p)
+{
+	zero_t z;
+	get_zero(z);
+	return get_alt_abs(sea_level_p) - z.alt;
+}
+
+/**
+ * @brief Returns altitude relative to zero position without powf() [m]
+ * 
+ * Evaluates a quadratic expansion of the barometric formula about the
+ * pressure at the last zero. Truncation error grows with the cube of the
+ * height change; near sea level it is under 1 cm within 100 m, about
+ * 0.1 m at 300 m and about 0.4 m at 500 m. Returns 0 before zeroing.
+ */
+float BMP180Alt::get_alt_rel()
+{
+	zero_t z;
+	get_zero(z);
+	float dp = bmp->get_pres() - z.pres;
+	return (z.c2 * dp + z.c1) * dp;
+}
+
+/**
+ * @brief Sets current altitude to zero position
+ * @param sea_level_p Sea-level pressure [kPa]
+ */
+void BMP180Alt::zero_alt(float sea_level_p)
+{
+	bmp->update();
+	set_zero(bmp->get_pres(), sea_level_p);
+}
+
+/**
+ * @brief Starts non-blocking zeroing averaged over many samples
+ * @param samples Number of pressure samples to average
+ * @param sea_level_p Sea-level pressure [kPa]
+ * 
+ * Each later pressure reading of the attached BMP180 (from update(),
+ * update_pres(), read_pres() or a scheduler) is fed to a running mean.
+ * This only posts the request under a new generation number; feed() takes
+ * it over on the next reading, so it is safe while a BMP180Worker thread
+ * samples the sensor, and a newer request replaces one in progress.
+ * When enough samples are accepted (or 4x as many have been seen) the zero
+ * position is set from the mean pressure in one step. Readings keep the
+ * previous zero until then.
+ */
+void BMP180Alt::zero_alt_start(uint16_t samples, float sea_level_p)
+{
+	zero_req_samples = (samples > 0) ? samples : 1;
+	zero_req_sea_level_p = sea_level_p;
+	BMP180ALT_BARRIER();
+	zero_req_gen++;
+}
+
+/**
+ * @brief Returns true if no averaged zeroing is requested or in progress
+ */
+bool BMP180Alt::zero_alt_done()
+{
+	uint8_t gen = zero_gen;
+	BMP180ALT_BARRIER();
+	return gen == zero_req_gen && zero_target == 0;
+}
+
+/**
+ * @brief Seeds averaged zeroing from first readings
+ * @param n Number of readings held in zero_seed_p
+ * 
+ * Takes the median and the median absolute deviation of the held readings,
+ * which a single spike among them cannot move far. Readings within 3
+ * standard deviations of the median (estimated as 1.4826 MAD) start the
+ * running mean; the estimate also gates later readings until 4 are in.
+ */
+void BMP180Alt::seed_zero(uint8_t n)
+{
+	// Sort copies of readings and of their deviations
+	float p[zero_seed], dev[zero_seed];
+	for (uint8_t i = 0; i < n; i++) { p[i] = zero_seed_p[i]; }
+	sort(p, n);
+	float med = p[n / 2];
+	for (uint8_t i = 0; i < n; i++) { dev[i] = fabsf(zero_seed_p[i] - med); }
+	sort(dev, n);
+	float sd = 1.4826f * dev[n / 2];
+	zero_var_seed = sd * sd;
+	float var = (zero_var_seed > zero_var_min) ? zero_var_seed : zero_var_min;
+
+	// Welford update with readings near median
+	for (uint8_t i = 0; i < n; i++)
+	{
+		float pres = zero_seed_p[i];
+		float d = pres - zero_mean;
+		float dm = pres - med;
+		if ((dm * dm) > 9.0f * var) { continue; }
+		zero_count++;
+		zero_mean += d / zero_count;
+		zero_m2 += d * (pres - zero_mean);
+	}
+}
+
+/**
+ * @brief Returns cached altitude above sea-level without zero offset [m]
+ * @param sea_level_p Sea-level pressure [kPa]
+ */
+float BMP180Alt::get_alt_abs(float sea_level_p)
+{
+	float pres = bmp->get_pres();
+	if (alt_pres != pres || alt_sea_level_p != sea_level_p)
+	{
+		alt_pres = pres;
+		alt_sea_level_p = sea_level_p;
+		alt_abs = 44330.0f * (1.0f - powf(pres / sea_level_p, 0.190295f));
+	}
+	return alt_abs;
+}
+
+/**
+ * @brief Sets zero position from pressure
+ * @param pres_0 Pressure at zero position [kPa]
+ * @param sea_level_p Sea-level pressure [kPa]
+ * 
+ * Also expands the barometric formula 44330 (1 - (p / p_s)^k) to second
+ * order about pres_0 for get_alt_rel(). The new zero is published under a
+ * sequence lock, so readers in the main loop never see a mix of old and
+ * new values when zeroing completes on a sampling thread. Non-positive
+ * pressures (e.g. an average with no accepted readings) are refused and
+ * the previous zero is kept, as they would make the coefficients NaN.
+ */
+void BMP180Alt::set_zero(float pres_0, float sea_level_p)
+{
+	if (!(pres_0 > 0.0f) || !(sea_level_p > 0.0f)) { return; }
+	const float k = 0.190295f;
+	float r = powf(pres_0 / sea_level_p, k);
+	zero_t z;
+	z.alt = 44330.0f * (1.0f - r);
+	z.pres = pres_0;
+	z.c1 = -44330.0f * k * r / pres_0;
+	z.c2 = 0.5f * z.c1 * (k - 1.0f) / pres_0;
+
+	// Odd lock value marks update in progress
+	zero_lock++;
+	BMP180ALT_BARRIER();
+	zero = z;
+	BMP180ALT_BARRIER();
+	zero_lock++;
+}
+
+/**
+ * @brief Reads consistent copy of zero position
+ * @param z Output zero position
+ * 
+ * Retries while set_zero() is running or has run during the copy.
+ */
+void BMP180Alt::get_zero(zero_t& z)
+{
+	while (true)
+	{
+		uint8_t lock = zero_lock;
+		BMP180ALT_BARRIER();
+		z = zero;
+		BMP180ALT_BARRIER();
+		if (!(lock & 1) && lock == zero_lock) { return; }
+	}
+}
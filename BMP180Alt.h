@@ -0,0 +1,69 @@
+/**
+ * @file BMP180Alt.h
+ * @brief Optional altitude features for BMP180
+ */
+#pragma once
+#include "BMP180.h"
+
+/**
+ * Class Declaration
+ */
+class BMP180Alt
+{
+public:
+
+	// Constructor and basics
+	BMP180Alt(BMP180* bmp);
+	void feed();
+
+	// Altitude
+	float get_alt(float sea_level_p = 101.325f);
+	float get_alt_rel();
+
+	// Altitude calibration
+	void zero_alt(float sea_level_p = 101.325f);
+	void zero_alt_start(uint16_t samples, float sea_level_p = 101.325f);
+	bool zero_alt_done();
+
+protected:
+
+	// Sensor
+	BMP180* bmp;
+
+	// Altitude cache
+	float alt_pres;
+	float alt_sea_level_p;
+	float alt_abs;
+	float get_alt_abs(float sea_level_p);
+
+	// Zero position and linearized relative altitude
+	typedef struct
+	{
+		float alt;	// Altitude at zero [m]
+		float pres;	// Pressure at zero [kPa]
+		float c1, c2;	// Expansion coefficients
+	}
+	zero_t;
+	zero_t zero;
+	volatile uint8_t zero_lock;
+	void set_zero(float pres_0, float sea_level_p);
+	void get_zero(zero_t& z);
+
+	// Zeroing request (written by zero_alt_start())
+	volatile uint16_t zero_req_samples;
+	volatile float zero_req_sea_level_p;
+	volatile uint8_t zero_req_gen;
+
+	// Averaged zeroing (written by feed() only)
+	static const float zero_var_min;
+	static const uint8_t zero_seed = 5;
+	volatile uint8_t zero_gen;
+	volatile uint16_t zero_target;
+	uint16_t zero_count;
+	uint32_t zero_seen;
+	float zero_mean, zero_m2;
+	float zero_var_seed;
+	float zero_seed_p[zero_seed];
+	float zero_sea_level_p;
+	void seed_zero(uint8_t n);
+};
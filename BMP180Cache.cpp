@@ -0,0 +1,101 @@
+/**
+ * @file BMP180Cache.cpp
+ */
+#include "BMP180Cache.h"
+
+/**
+ * @brief Constructs compensation cache
+ * @param table UT to B5 table storage owned by caller, or NULL for none
+ * @param ut_min First UT covered by the table
+ * @param size Number of UT codes covered
+ * 
+ * Attach as the cache entry of BMP180::set_companions(). The table is
+ * filled from the calibration by BMP180::init(), or by set_companions()
+ * if init() has already run, so no reading pays for it. UT codes inside
+ * the window then cost one table read instead of a multiply and a signed
+ * divide; codes outside it fall back to the exact computation.
+ * 
+ * Table memory is 2 bytes per UT code. The datasheet calibration reads
+ * UT 26176 at 0 deg C and 31185 at 40 deg C, about 125 codes per deg C,
+ * so that window takes 5009 entries, about 10 KB. BMP180::inv_temp() gives
+ * the window bounds for a part's own calibration. Without a table the
+ * cache still keeps the pressure terms, which costs 17 bytes.
+ */
+BMP180Cache::BMP180Cache(int16_t* table, uint16_t ut_min, uint16_t size)
+{
+	this->table = table;
+	this->table_min = ut_min;
+	this->table_size = (table != NULL) ? size : 0;
+	this->table_built = false;
+	this->pres_b5 = 0;
+	this->pres_oss = 0xFF;
+	this->pres_b3 = 0;
+	this->pres_b4 = 0;
+	this->pres_b4_inv = 0;
+}
+
+/**
+ * @brief Fills UT to B5 lookup table and invalidates cached terms
+ * @param cal Calibration coefficients
+ * 
+ * Called by BMP180::init() and set_companions(), as all terms depend on
+ * the calibration. Takes one B5 computation (a signed divide) per table
+ * entry. Entries whose B5 does not fit 16 bits are marked for exact
+ * fallback.
+ */
+void BMP180Cache::init(const BMP180::cal_t& cal)
+{
+	for (uint16_t i = 0; i < table_size; i++)
+	{
+		int32_t b5_i = BMP180::comp_b5(cal, (int32_t)table_min + i);
+		bool fits = (b5_i > table_none) && (b5_i <= 32767);
+		table[i] = fits ? (int16_t)b5_i : table_none;
+	}
+	table_built = true;
+	pres_b5 = 0;
+	pres_oss = 0xFF;
+	pres_b3 = 0;
+	pres_b4 = 0;
+	pres_b4_inv = 0;
+}
+
+/**
+ * @brief Computes temperature compensation term B5
+ * @param cal Calibration coefficients
+ * @param ut Uncompensated temperature
+ */
+int32_t BMP180Cache::comp_b5(const BMP180::cal_t& cal, int32_t ut)
+{
+	uint16_t i = (uint16_t)(ut - table_min);
+	if (table_built && i < table_size && table[i] != table_none) { return table[i]; }
+	return BMP180::comp_b5(cal, ut);
+}
+
+/**
+ * @brief Computes pressure [Pa] with terms cached per temperature
+ * @param cal Calibration coefficients
+ * @param b5 Temperature compensation term
+ * @param up Uncompensated pressure
+ * @param oss Oversampling setting (0-3)
+ * 
+ * The first reading at a new B5 or setting divides directly, as in the
+ * datasheet; from the second reading at the same B5 on, a cached
+ * reciprocal replaces the division.
+ */
+int32_t BMP180Cache::comp_pres(const BMP180::cal_t& cal, int32_t b5, uint32_t up, uint8_t oss)
+{
+	if (oss != pres_oss || b5 != pres_b5)
+	{
+		// New temperature: one direct division
+		pres_b5 = b5;
+		pres_oss = oss;
+		pres_b3 = BMP180::comp_b3(cal, b5, oss);
+		pres_b4 = BMP180::comp_b4(cal, b5);
+		pres_b4_inv = 0;
+		return BMP180::comp_pres(pres_b3, pres_b4, up, oss);
+	}
+
+	// Repeated temperature: reciprocal from second reading on
+	if (pres_b4_inv == 0) { pres_b4_inv = BMP180::comp_b4_inv(pres_b4); }
+	return BMP180::comp_pres(pres_b3, pres_b4, pres_b4_inv, up, oss);
+}
@@ -0,0 +1,37 @@
+/**
+ * @file BMP180Cache.h
+ * @brief Optional compensation caches for integer BMP180 builds
+ */
+#pragma once
+#include "BMP180.h"
+
+/**
+ * Class Declaration
+ */
+class BMP180Cache
+{
+public:
+
+	// Constructor and basics
+	BMP180Cache(int16_t* table = NULL, uint16_t ut_min = 0, uint16_t size = 0);
+	void init(const BMP180::cal_t& cal);
+
+	// Cached compensation
+	int32_t comp_b5(const BMP180::cal_t& cal, int32_t ut);
+	int32_t comp_pres(const BMP180::cal_t& cal, int32_t b5, uint32_t up, uint8_t oss);
+
+protected:
+
+	// UT to B5 lookup table
+	static const int16_t table_none = -32768;
+	int16_t* table;
+	uint16_t table_min;
+	uint16_t table_size;
+	bool table_built;
+
+	// Pressure terms cached per B5
+	int32_t pres_b5;
+	uint8_t pres_oss;
+	int32_t pres_b3;
+	uint32_t pres_b4, pres_b4_inv;	// Reciprocal 0 until second use
+};
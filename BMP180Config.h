@@ -0,0 +1,19 @@
+/**
+ * @file BMP180Config.h
+ * @brief Build options for the BMP180 driver
+ * 
+ * Options change the layout of the BMP180 class, so they must be the same
+ * for the library and for every file including BMP180.h. Set them here,
+ * or as a global build flag. Never #define them in a sketch: on Arduino
+ * that does not reach the library's own BMP180.cpp.
+ */
+#pragma once
+
+/**
+ * Compensation Mode
+ * 
+ * Define BMP180_FLOAT_COMP to use the single-precision formulation of the
+ * compensation, which is faster on cores with a hardware FPU. BMP180Cache
+ * is integer-only and is ignored by float builds.
+ */
+// #define BMP180_FLOAT_COMP
@@ -0,0 +1,122 @@
+/**
+ * @file BMP180Filter.cpp
+ */
+#include "BMP180Filter.h"
+
+/**
+ * @brief Constructs spike rejector
+ * @param buffer Storage of 2 * size floats owned by caller
+ * @param size Window size (odd, e.g. 5-15)
+ * @param k Rejection threshold [deviations]
+ * @param min_dev Deviation floor [input units]
+ * 
+ * A sample further than k deviations from the window median is flagged
+ * and replaced by the median. The deviation is a running mean absolute
+ * deviation from the median, scaled to sigma, and updated only by
+ * accepted samples. The floor keeps quantization noise from rejecting
+ * good data. Raw samples always enter the window, so genuine steps pass
+ * through after half a window.
+ */
+BMP180Filter::BMP180Filter(float* buffer, uint8_t size, float k, float min_dev)
+{
+	this->window = buffer;
+	this->sorted = buffer + size;
+	this->size = size;
+	this->k = k;
+	this->min_dev = min_dev;
+	reset();
+}
+
+/**
+ * @brief Filters one sample
+ * @param x New sample
+ * @return Sample, or window median if x is an outlier
+ * 
+ * The median is kept in a sorted copy of the window. Each sample costs a
+ * binary search plus a shift of up to N floats, so the update is O(N),
+ * which is cheap at the intended window sizes and needs no allocation.
+ */
+float BMP180Filter::apply(float x)
+{
+	// Remove oldest sample from sorted window
+	if (count == size)
+	{
+		uint8_t i = find(window[head]);
+		for (; i + 1 < count; i++) { sorted[i] = sorted[i + 1]; }
+		count--;
+	}
+
+	// Insert new sample
+	window[head] = x;
+	head = (head + 1 < size) ? head + 1 : 0;
+	uint8_t i = find(x);
+	for (uint8_t j = count; j > i; j--) { sorted[j] = sorted[j - 1]; }
+	sorted[i] = x;
+	count++;
+
+	// Pass through until window is full
+	outlier = false;
+	if (count < size)
+	{
+		return x;
+	}
+
+	// Compare to median
+	float median = sorted[count >> 1];
+	float d = (x > median) ? x - median : median - x;
+	float limit = k * ((dev > min_dev) ? dev : min_dev);
+	if (d > limit)
+	{
+		outlier = true;
+		outliers++;
+		return median;
+	}
+	// Mean absolute deviation of a normal is sigma * sqrt(2 / pi)
+	dev += (1.2533f * d - dev) * 0.0625f;
+	return x;
+}
+
+/**
+ * @brief Empties window and clears outlier state
+ */
+void BMP180Filter::reset()
+{
+	count = 0;
+	head = 0;
+	dev = min_dev;
+	outlier = false;
+	outliers = 0;
+}
+
+/**
+ * @brief Returns true if last sample was replaced
+ */
+bool BMP180Filter::is_outlier()
+{
+	return outlier;
+}
+
+/**
+ * @brief Returns number of samples replaced since reset
+ */
+uint32_t BMP180Filter::get_outliers()
+{
+	return outliers;
+}
+
+/**
+ * @brief Returns first sorted index whose value is not below x
+ * @param x Value to locate
+ */
+uint8_t BMP180Filter::find(float x)
+{
+	uint8_t lo = 0;
+	uint8_t hi = count;
+	while (lo < hi)
+	{
+		uint8_t mid = (lo + hi) >> 1;
+		if (sorted[mid] < x) { lo = mid + 1; }
+		else { hi = mid; }
+	}
+	return lo;
+}
@@ -0,0 +1,46 @@
+/**
+ * @file BMP180Filter.h
+ * @brief Streaming Hampel spike rejector for BMP180 pressure
+ * 
+ * Keeps a sorted copy of the sliding window for the median; each sample
+ * is inserted with an O(N) shift.
+ */
+#pragma once
+#include <stdint.h>
+
+/**
+ * Class Declaration
+ */
+class BMP180Filter
+{
+public:
+
+	// Constructor and basics
+	BMP180Filter(float* buffer, uint8_t size, float k = 3.0f, float min_dev = 0.01f);
+	float apply(float x);
+	void reset();
+
+	// Outlier reporting
+	bool is_outlier();
+	uint32_t get_outliers();
+
+protected:
+
+	// Sliding window (arrival order and sorted)
+	float* window;
+	float* sorted;
+	uint8_t size;
+	uint8_t count;
+	uint8_t head;
+
+	// Rejection parameters
+	float k;
+	float min_dev;
+	float dev;
+
+	// Outlier state
+	bool outlier;
+	uint32_t outliers;
+
+	uint8_t find(float x);
+};
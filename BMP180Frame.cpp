@@ -0,0 +1,149 @@
+/**
+ * @file BMP180Frame.cpp
+ */
+#include "BMP180Frame.h"
+#include <string.h>
+
+/**
+ * @brief Constructs frame encoder
+ * @param buffer Frame storage owned by caller
+ * @param size Buffer size [bytes]
+ * @param fields OR of field_t flags to include per sample
+ * @param decimation Keep one of every this many samples
+ * @param sensor Sensor index written to each frame header
+ * 
+ * Frame layout (all values MSB first):
+ * - Sample count (1 byte)
+ * - Field flags (1 byte)
+ * - Sensor index (1 byte)
+ * - Samples with the selected fields in field_t order
+ * 
+ * A sensor-owning process keeps one encoder per subscriber and writes each
+ * full frame to that subscriber's socket, so the syscall cost is paid once
+ * per batch rather than once per sample.
+ */
+BMP180Frame::BMP180Frame(uint8_t* buffer, uint16_t size, uint8_t fields, uint16_t decimation, uint8_t sensor)
+{
+	this->buffer = buffer;
+	this->size = size;
+	this->sensor = sensor;
+	this->fields = fields;
+	this->decimation = (decimation > 0) ? decimation : 1;
+	this->skip = 0;
+	this->sample_len = 0;
+	if (fields & field_seq) { sample_len += 4; }
+	if (fields & field_time) { sample_len += 4; }
+	if (fields & field_temp) { sample_len += 4; }
+	if (fields & field_pres) { sample_len += 4; }
+	if (fields & field_raw) { sample_len += 6; }
+	clear();
+}
+
+/**
+ * @brief Adds sample to frame subject to decimation
+ * @param sample Sample to add
+ * @param time_us Sample timestamp [us]
+ * @return True if sample was added
+ * 
+ * Samples are not added once the frame is full.
+ */
+bool BMP180Frame::add(const BMP180::sample_t& sample, uint32_t time_us)
+{
+	// Decimate
+	if (skip > 0)
+	{
+		skip--;
+		return false;
+	}
+	if (is_full())
+	{
+		return false;
+	}
+	skip = decimation - 1;
+
+	// Append selected fields
+	if (fields & field_seq) { put_u32(sample.seq); }
+	if (fields & field_time) { put_u32(time_us); }
+	if (fields & field_temp) { put_float(sample.temp); }
+	if (fields & field_pres) { put_float(sample.pres); }
+	if (fields & field_raw)
+	{
+		put_u16((uint16_t)sample.ut);
+		put_u32(sample.up);
+	}
+	buffer[0]++;
+	return true;
+}
+
+/**
+ * @brief Returns true if frame has no room for another sample
+ */
+bool BMP180Frame::is_full()
+{
+	return (length + sample_len > size) || (buffer[0] == 0xFF);
+}
+
+/**
+ * @brief Empties frame for the next batch
+ */
+void BMP180Frame::clear()
+{
+	buffer[0] = 0;
+	buffer[1] = fields;
+	buffer[2] = sensor;
+	length = header_len;
+}
+
+/**
+ * @brief Returns frame bytes
+ */
+const uint8_t* BMP180Frame::get_data()
+{
+	return buffer;
+}
+
+/**
+ * @brief Returns frame length [bytes]
+ */
+uint16_t BMP180Frame::get_length()
+{
+	return length;
+}
+
+/**
+ * @brief Returns number of samples in frame
+ */
+uint8_t BMP180Frame::get_count()
+{
+	return buffer[0];
+}
+
+/**
+ * @brief Appends 16-bit value MSB first
+ */
+void BMP180Frame::put_u16(uint16_t value)
+{
+	buffer[length++] = (uint8_t)(value >> 8);
+	buffer[length++] = (uint8_t)(value);
+}
+
+/**
+ * @brief Appends 32-bit value MSB first
+ */
+void BMP180Frame::put_u32(uint32_t value)
+{
+	buffer[length++] = (uint8_t)(value >> 24);
+	buffer[length++] = (uint8_t)(value >> 16);
+	buffer[length++] = (uint8_t)(value >> 8);
+	buffer[length++] = (uint8_t)(value);
+}
+
+/**
+ * @brief Appends IEEE-754 float MSB first
+ */
+void BMP180Frame::put_float(float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, 4);
+	put_u32(bits);
+}
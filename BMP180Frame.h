@@ -0,0 +1,57 @@
+/**
+ * @file BMP180Frame.h
+ * @brief Batched binary frame encoder for BMP180 sample subscriptions
+ */
+#pragma once
+#include "BMP180.h"
+
+/**
+ * Class Declaration
+ */
+class BMP180Frame
+{
+public:
+
+	// Field selection flags
+	typedef enum
+	{
+		field_seq = 0x01,	// Sequence number (4 bytes)
+		field_time = 0x02,	// Timestamp [us] (4 bytes)
+		field_temp = 0x04,	// Temperature [deg C] (4-byte float)
+		field_pres = 0x08,	// Pressure [kPa] (4-byte float)
+		field_raw = 0x10,	// Raw UT and UP (2 + 4 bytes)
+	}
+	field_t;
+
+	// Constructor and basics
+	BMP180Frame(uint8_t* buffer, uint16_t size, uint8_t fields, uint16_t decimation = 1, uint8_t sensor = 0);
+	bool add(const BMP180::sample_t& sample, uint32_t time_us);
+	bool is_full();
+	void clear();
+
+	// Frame data
+	const uint8_t* get_data();
+	uint16_t get_length();
+	uint8_t get_count();
+
+protected:
+
+	// Frame header
+	static const uint16_t header_len = 3;
+
+	// Buffer
+	uint8_t* buffer;
+	uint16_t size;
+	uint16_t length;
+	uint8_t sample_len;
+
+	// Subscription
+	uint8_t sensor;
+	uint8_t fields;
+	uint16_t decimation;
+	uint16_t skip;
+
+	void put_u16(uint16_t value);
+	void put_u32(uint32_t value);
+	void put_float(float value);
+};
@@ -0,0 +1,63 @@
+/**
+ * @file BMP180Loop.cpp
+ */
+#include "BMP180Loop.h"
+
+/**
+ * @brief Constructs BMP180 event loop
+ * @param scheds Array of schedulers, one per sensor
+ * @param count Number of schedulers
+ * @param callback Called with scheduler index on each new pressure sample
+ * @param arg Context pointer passed to callback
+ * 
+ * The loop never blocks. Each sensor's conversion runs on-chip while the
+ * loop services the others, so one thread can drive sensors spread over
+ * any number of buses.
+ * 
+ * Loops share no state, so acquisition can also be split into one loop per
+ * physical bus, each run by its own thread (see BMP180Worker).
+ */
+BMP180Loop::BMP180Loop(BMP180Scheduler** scheds, uint8_t count, callback_t callback, void* arg)
+{
+	this->scheds = scheds;
+	this->count = count;
+	this->callback = callback;
+	this->arg = arg;
+}
+
+/**
+ * @brief Starts all schedulers
+ * @param now_us Current time [us]
+ */
+void BMP180Loop::start(uint32_t now_us)
+{
+	for (uint8_t i = 0; i < count; i++)
+	{
+		scheds[i]->start(now_us);
+	}
+}
+
+/**
+ * @brief Services all due schedulers
+ * @param now_us Current time [us]
+ * @return Earliest time any scheduler next has work to do [us]
+ * 
+ * Arm a single one-shot timer (e.g. a timerfd waited on with epoll) for the
+ * returned time and call poll() again when it fires. BMP180Epoll in the
+ * extras folder does this on Linux.
+ */
+uint32_t BMP180Loop::poll(uint32_t now_us)
+{
+	int32_t wait_us = 0x7FFFFFFF;
+	for (uint8_t i = 0; i < count; i++)
+	{
+		if (scheds[i]->poll(now_us) && callback)
+		{
+			callback(arg, i);
+		}
+		int32_t next_us = (int32_t)(scheds[i]->get_next_us() - now_us);
+		if (next_us < wait_us) { wait_us = next_us; }
+	}
+	if (wait_us < 0) { wait_us = 0; }
+	return now_us + (uint32_t)wait_us;
+}
@@ -0,0 +1,28 @@
+/**
+ * @file BMP180Loop.h
+ * @brief Single-threaded event loop driving many BMP180 schedulers
+ */
+#pragma once
+#include "BMP180Scheduler.h"
+
+/**
+ * Class Declaration
+ */
+class BMP180Loop
+{
+public:
+
+	// Sample callback (context, index into scheduler array)
+	typedef void (*callback_t)(void* arg, uint8_t index);
+
+	// Constructor and basics
+	BMP180Loop(BMP180Scheduler** scheds, uint8_t count, callback_t callback, void* arg = NULL);
+	void start(uint32_t now_us);
+	uint32_t poll(uint32_t now_us);
+
+protected:
+	BMP180Scheduler** scheds;
+	uint8_t count;
+	callback_t callback;
+	void* arg;
+};
@@ -0,0 +1,156 @@
+/**
+ * @file BMP180Queue.cpp
+ */
+#include "BMP180Queue.h"
+
+/**
+ * Memory barrier between index and buffer accesses
+ */
+#define BMP180QUEUE_BARRIER() __sync_synchronize()
+
+/**
+ * @brief Constructs sample queue
+ * @param buffer Sample storage owned by caller
+ * @param size Buffer size (power of 2, at most 32768, at least 2 for drop_oldest)
+ * @param policy Behavior when queue is full
+ * 
+ * Policies:
+ * - drop_oldest = Producer never waits, consumer skips overwritten samples
+ * - drop_newest = Producer never waits, incoming sample is discarded
+ * - block = Producer waits for space (never use from an interrupt)
+ * 
+ * One producer (sampler) and one consumer may use the queue concurrently
+ * without locks. With drop_oldest, one slot is kept as a guard so the
+ * consumer can detect a slot being overwritten while it reads; a
+ * one-slot drop_oldest queue has no room for it and falls back to
+ * drop_newest.
+ */
+BMP180Queue::BMP180Queue(BMP180::sample_t* buffer, uint16_t size, policy_t policy)
+{
+	if (policy == drop_oldest && size < 2) { policy = drop_newest; }
+	this->buffer = buffer;
+	this->mask = size - 1;
+	this->capacity = (policy == drop_oldest) ? size - 1 : size;
+	this->policy = policy;
+	this->head = 0;
+	this->tail = 0;
+	this->wait = NULL;
+	this->wait_arg = NULL;
+	this->pushed = 0;
+	this->dropped = 0;
+	this->blocked = 0;
+}
+
+/**
+ * @brief Pushes sample (producer side)
+ * @param sample Sample to push
+ * @return False if sample was discarded (drop_newest only)
+ */
+bool BMP180Queue::push(const BMP180::sample_t& sample)
+{
+	uint32_t h = head;
+	if ((h - tail) >= capacity)
+	{
+		switch (policy)
+		{
+			case drop_oldest:
+				dropped++;
+				break;
+			case drop_newest:
+				dropped++;
+				return false;
+			case block:
+				blocked++;
+				while ((h - tail) >= capacity)
+				{
+					if (wait) { wait(wait_arg, block_wait_us); }
+					BMP180QUEUE_BARRIER();
+				}
+				break;
+		}
+	}
+	buffer[h & mask] = sample;
+	BMP180QUEUE_BARRIER();
+	head = h + 1;
+	pushed++;
+	return true;
+}
+
+/**
+ * @brief Pops oldest sample (consumer side)
+ * @param sample Output sample
+ * @return False if queue is empty
+ */
+bool BMP180Queue::pop(BMP180::sample_t& sample)
+{
+	while (true)
+	{
+		// Skip samples the producer has lapped
+		uint32_t h = head;
+		uint32_t t = tail;
+		if (h == t) { return false; }
+		if ((h - t) > capacity) { t = h - capacity; }
+		BMP180QUEUE_BARRIER();
+		sample = buffer[t & mask];
+		BMP180QUEUE_BARRIER();
+
+		// Retry if slot was overwritten during copy
+		if (policy == drop_oldest && (head - t) > capacity)
+		{
+			tail = t;
+			continue;
+		}
+		tail = t + 1;
+		return true;
+	}
+}
+
+/**
+ * @brief Returns number of queued samples
+ */
+uint16_t BMP180Queue::get_count()
+{
+	uint32_t count = head - tail;
+	return (count > capacity) ? capacity : count;
+}
+
+/**
+ * @brief Sets function called while a push is blocked
+ * @param wait Function waiting the given time [us]
+ * @param arg Context pointer passed to wait
+ * 
+ * Only used by the block policy. With NULL the producer busy-spins.
+ */
+void BMP180Queue::set_wait(BMP180::wait_t wait, void* arg)
+{
+	this->wait = wait;
+	this->wait_arg = arg;
+}
+
+/**
+ * @brief Returns number of samples accepted into the queue
+ */
+uint32_t BMP180Queue::get_pushed()
+{
+	return pushed;
+}
+
+/**
+ * @brief Returns number of samples lost to a full queue
+ * 
+ * Counted by the producer as it overwrites or discards. With drop_oldest,
+ * a sample the consumer pops while it is being overwritten may still be
+ * counted, so the count can run one high per such race.
+ */
+uint32_t BMP180Queue::get_dropped()
+{
+	return dropped;
+}
+
+/**
+ * @brief Returns number of pushes that had to wait (block only)
+ */
+uint32_t BMP180Queue::get_blocked()
+{
+	return blocked;
+}
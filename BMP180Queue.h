@@ -0,0 +1,55 @@
+/**
+ * @file BMP180Queue.h
+ * @brief Bounded lock-free SPSC queue of BMP180 samples
+ */
+#pragma once
+#include "BMP180.h"
+
+/**
+ * Class Declaration
+ */
+class BMP180Queue
+{
+public:
+
+	// Full-queue policies
+	typedef enum
+	{
+		drop_oldest,	// Overwrite oldest sample
+		drop_newest,	// Discard incoming sample
+		block,		// Wait for consumer
+	}
+	policy_t;
+
+	// Constructor and basics
+	BMP180Queue(BMP180::sample_t* buffer, uint16_t size, policy_t policy = drop_oldest);
+	bool push(const BMP180::sample_t& sample);
+	bool pop(BMP180::sample_t& sample);
+	uint16_t get_count();
+	void set_wait(BMP180::wait_t wait, void* arg = NULL);
+
+	// Counters
+	uint32_t get_pushed();
+	uint32_t get_dropped();
+	uint32_t get_blocked();
+
+protected:
+
+	// Buffer and indices
+	BMP180::sample_t* buffer;
+	uint16_t mask;
+	uint16_t capacity;
+	policy_t policy;
+	volatile uint32_t head;
+	volatile uint32_t tail;
+
+	// Blocking wait
+	static const uint32_t block_wait_us = 100;
+	BMP180::wait_t wait;
+	void* wait_arg;
+
+	// Counters
+	volatile uint32_t pushed;
+	volatile uint32_t dropped;
+	volatile uint32_t blocked;
+};
@@ -0,0 +1,163 @@
+/**
+ * @file BMP180Ring.cpp
+ */
+#include "BMP180Ring.h"
+
+/**
+ * Memory barrier between lock and record accesses
+ */
+#define BMP180RING_BARRIER() __sync_synchronize()
+
+/**
+ * @brief Constructs ring view of shared memory
+ * @param memory Memory of at least get_bytes(size) bytes (e.g. mmap)
+ * @param size Number of slots (power of 2)
+ * 
+ * The publisher calls init() once; each reader calls attach(). Every slot
+ * carries its own seqlock, so readers copy records straight out of the
+ * shared memory with no syscalls and never stall the publisher. Readers
+ * never write the memory, so it may be mapped read-only for them. On Linux,
+ * extras/BMP180Shm creates and maps the memory for both sides.
+ */
+BMP180Ring::BMP180Ring(void* memory, uint16_t size)
+{
+	this->header = (header_t*)memory;
+	this->slots = (slot_t*)(header + 1);
+	this->mask = size - 1;
+	this->cursor = 0;
+	this->lost = 0;
+}
+
+/**
+ * @brief Returns shared memory size required for given slot count [bytes]
+ * @param size Number of slots
+ */
+uint32_t BMP180Ring::get_bytes(uint16_t size)
+{
+	return sizeof(header_t) + (uint32_t)size * sizeof(slot_t);
+}
+
+/**
+ * @brief Initializes shared memory (publisher only)
+ */
+void BMP180Ring::init()
+{
+	header->head = 0;
+	header->size = mask + 1;
+	for (uint32_t i = 0; i <= mask; i++)
+	{
+		slots[i].lock = 0;
+	}
+	BMP180RING_BARRIER();
+	header->magic = ring_magic;
+}
+
+/**
+ * @brief Publishes sample (publisher only)
+ * @param sample Sample to publish
+ * @param time_us Sample timestamp [us]
+ */
+void BMP180Ring::publish(const BMP180::sample_t& sample, uint32_t time_us)
+{
+	uint32_t h = header->head;
+	slot_t& slot = slots[h & mask];
+	slot.lock++;
+	BMP180RING_BARRIER();
+	slot.record.time_us = time_us;
+	slot.record.sample = sample;
+	BMP180RING_BARRIER();
+	slot.lock++;
+	header->head = h + 1;
+}
+
+/**
+ * @brief Attaches reader to initialized ring
+ * @return False if publisher has not initialized the memory
+ * 
+ * Starts the reader cursor at the newest sample.
+ */
+bool BMP180Ring::attach()
+{
+	if (header->magic != ring_magic || header->size != (uint16_t)(mask + 1))
+	{
+		return false;
+	}
+	cursor = header->head;
+	lost = 0;
+	return true;
+}
+
+/**
+ * @brief Copies newest record
+ * @param record Output record
+ * @return False if nothing has been published yet
+ */
+bool BMP180Ring::read_latest(record_t& record)
+{
+	while (true)
+	{
+		uint32_t h = header->head;
+		if (h == 0) { return false; }
+		if (read(h - 1, record)) { return true; }
+	}
+}
+
+/**
+ * @brief Copies next unread record
+ * @param record Output record
+ * @return False if no new record is available
+ * 
+ * Records overwritten before they were read are skipped and counted.
+ * 
+ * If the publisher restarts and calls init() again, the shared head goes
+ * back to 0 while this reader's cursor stays ahead of it. The gap then
+ * looks like a wrapped ring: get_lost() jumps by nearly 2^32 and reading
+ * resumes mask slots behind the new head, where slots not yet rewritten
+ * still hold records from before the restart. A jump of 2^31 or more in
+ * get_lost() therefore means a restart; call attach() again to continue
+ * from the new head.
+ */
+bool BMP180Ring::read_next(record_t& record)
+{
+	while (true)
+	{
+		uint32_t h = header->head;
+		if (cursor == h) { return false; }
+		if (h - cursor > mask)
+		{
+			lost += h - cursor - mask;
+			cursor = h - mask;
+		}
+		if (read(cursor, record))
+		{
+			cursor++;
+			return true;
+		}
+	}
+}
+
+/**
+ * @brief Returns number of records this reader missed
+ */
+uint32_t BMP180Ring::get_lost()
+{
+	return lost;
+}
+
+/**
+ * @brief Copies record under slot seqlock
+ * @param index Ring index to read
+ * @param record Output record
+ * @return False if slot was being written or reused for a later index
+ */
+bool BMP180Ring::read(uint32_t index, record_t& record)
+{
+	slot_t& slot = slots[index & mask];
+	uint32_t lock = slot.lock;
+	if (lock & 1) { return false; }
+	BMP180RING_BARRIER();
+	record = slot.record;
+	BMP180RING_BARRIER();
+	if (slot.lock != lock) { return false; }
+	return (header->head - index) <= (uint32_t)mask + 1;
+}
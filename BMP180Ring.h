@@ -0,0 +1,63 @@
+/**
+ * @file BMP180Ring.h
+ * @brief Seqlock sample ring for sharing BMP180 samples between processes
+ */
+#pragma once
+#include "BMP180.h"
+
+/**
+ * Class Declaration
+ */
+class BMP180Ring
+{
+public:
+
+	// Published record
+	typedef struct
+	{
+		uint32_t time_us;		// Publish timestamp [us]
+		BMP180::sample_t sample;	// Sample data
+	}
+	record_t;
+
+	// Constructor and basics
+	BMP180Ring(void* memory, uint16_t size);
+	static uint32_t get_bytes(uint16_t size);
+
+	// Publisher
+	void init();
+	void publish(const BMP180::sample_t& sample, uint32_t time_us);
+
+	// Reader
+	bool attach();
+	bool read_latest(record_t& record);
+	bool read_next(record_t& record);
+	uint32_t get_lost();
+
+protected:
+
+	// Shared memory layout
+	typedef struct
+	{
+		uint32_t magic;
+		uint16_t size;
+		volatile uint32_t head;
+	}
+	header_t;
+	typedef struct
+	{
+		volatile uint32_t lock;
+		record_t record;
+	}
+	slot_t;
+	static const uint32_t ring_magic = 0x42313830;
+
+	// Local state
+	header_t* header;
+	slot_t* slots;
+	uint16_t mask;
+	uint32_t cursor;
+	uint32_t lost;
+
+	bool read(uint32_t index, record_t& record);
+};
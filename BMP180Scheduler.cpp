@@ -0,0 +1,192 @@
+/**
+ * @file BMP180Scheduler.cpp
+ */
+#include "BMP180Scheduler.h"
+
+/**
+ * @brief Constructs BMP180 scheduler
+ * @param bmp BMP180 to sample (must already be initialized)
+ * @param period_us Pressure sample period [us] (0 is raised to 1)
+ * 
+ * Temperature is refreshed whenever bmp->temp_due(), so the sensor's
+ * temp_age_max setting (and its drift adaptation) applies here too.
+ */
+BMP180Scheduler::BMP180Scheduler(BMP180* bmp, uint32_t period_us)
+{
+	this->bmp = bmp;
+	this->period_us = (period_us > 0) ? period_us : 1;
+	this->deadline_us = 0;
+	this->ready_us = 0;
+	this->state = state_idle;
+	this->temp_late = 0;
+	reset_stats();
+}
+
+/**
+ * @brief Starts sampling with an initial temperature conversion
+ * @param now_us Current time [us]
+ * 
+ * The first pressure deadline is placed right after the temperature
+ * conversion. All later deadlines are absolute multiples of the period
+ * from there, so bus time and late polls never accumulate into drift.
+ */
+void BMP180Scheduler::start(uint32_t now_us)
+{
+	bmp->start_temp();
+	ready_us = now_us + bmp->get_temp_time_us();
+	deadline_us = ready_us;
+	temp_late = 0;
+	state = state_temp;
+}
+
+/**
+ * @brief Advances scheduler
+ * @param now_us Current time [us]
+ * @return True if a new pressure sample is available in the BMP180
+ * 
+ * Call from the main loop or a thread at or after get_next_us(). Calling
+ * early is harmless. Each step is a blocking I2C transfer, which hangs or
+ * fails inside an interrupt on both Arduino (Wire needs the TWI
+ * interrupt) and Mbed (the I2C API takes a mutex), so a hardware timer
+ * should only set a flag or wake that context.
+ * 
+ * Temperature refreshes are planned into the gap after a pressure read
+ * when it fits before the next deadline; otherwise one pressure slot is
+ * given up for them. A slot is also given up once a refresh has been due
+ * for temp_late_max samples, so late polls that keep shrinking the gap
+ * cannot leave the temperature stale forever.
+ */
+bool BMP180Scheduler::poll(uint32_t now_us)
+{
+	switch (state)
+	{
+		case state_idle:
+		{
+			if (!reached(now_us, deadline_us)) { return false; }
+
+			// Skip over missed deadlines
+			uint32_t late_us = now_us - deadline_us;
+			if (late_us >= period_us)
+			{
+				uint32_t skipped = late_us / period_us;
+				missed += skipped;
+				deadline_us += skipped * period_us;
+				late_us -= skipped * period_us;
+			}
+			if (late_us > jitter_us) { jitter_us = late_us; }
+			deadline_us += period_us;
+
+			// Give up slot for temperature if it never fits in a gap, or
+			// if poll latency has kept it out of the gaps for too long
+			uint32_t conv_us = bmp->get_pres_time_us() + bmp->get_temp_time_us();
+			if (bmp->temp_due() && (conv_us > period_us || temp_late >= temp_late_max))
+			{
+				bmp->start_temp();
+				ready_us = now_us + bmp->get_temp_time_us();
+				temp_late = 0;
+				state = state_temp;
+				return false;
+			}
+
+			// Start pressure conversion
+			bmp->start_pres();
+			ready_us = now_us + bmp->get_pres_time_us();
+			state = state_pres;
+			return false;
+		}
+		case state_pres:
+		{
+			if (!reached(now_us, ready_us)) { return false; }
+			bmp->read_pres();
+
+			// Refresh temperature in gap before next deadline
+			uint32_t gap_us = deadline_us - now_us;
+			if (!bmp->temp_due())
+			{
+				state = state_idle;
+			}
+			else if (reached(deadline_us, now_us) && gap_us >= bmp->get_temp_time_us())
+			{
+				bmp->start_temp();
+				ready_us = now_us + bmp->get_temp_time_us();
+				temp_late = 0;
+				state = state_temp;
+			}
+			else
+			{
+				if (temp_late < temp_late_max) { temp_late++; }
+				state = state_idle;
+			}
+			return true;
+		}
+		case state_temp:
+		{
+			if (!reached(now_us, ready_us)) { return false; }
+			bmp->read_temp();
+			state = state_idle;
+			return false;
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief Returns time at which poll() next has work to do [us]
+ * 
+ * Suitable for arming a one-shot timer (timerfd, hardware compare, etc).
+ */
+uint32_t BMP180Scheduler::get_next_us()
+{
+	return (state == state_idle) ? deadline_us : ready_us;
+}
+
+/**
+ * @brief Returns sampled BMP180
+ */
+BMP180* BMP180Scheduler::get_bmp()
+{
+	return bmp;
+}
+
+/**
+ * @brief Returns sampling period [us]
+ */
+uint32_t BMP180Scheduler::get_period_us()
+{
+	return period_us;
+}
+
+/**
+ * @brief Returns worst lateness of a conversion start since last reset [us]
+ */
+uint32_t BMP180Scheduler::get_jitter_us()
+{
+	return jitter_us;
+}
+
+/**
+ * @brief Returns number of missed deadlines since last reset
+ */
+uint32_t BMP180Scheduler::get_missed()
+{
+	return missed;
+}
+
+/**
+ * @brief Resets jitter and missed-deadline statistics
+ */
+void BMP180Scheduler::reset_stats()
+{
+	jitter_us = 0;
+	missed = 0;
+}
+
+/**
+ * @brief Returns true if time_us has been reached at now_us
+ * 
+ * Safe across 32-bit timer wraparound.
+ */
+bool BMP180Scheduler::reached(uint32_t now_us, uint32_t time_us)
+{
+	return (int32_t)(now_us - time_us) >= 0;
+}
@@ -0,0 +1,55 @@
+/**
+ * @file BMP180Scheduler.h
+ * @brief Fixed-rate non-blocking sampling scheduler for BMP180
+ */
+#pragma once
+#include "BMP180.h"
+
+/**
+ * Class Declaration
+ */
+class BMP180Scheduler
+{
+public:
+
+	// Constructor and basics
+	BMP180Scheduler(BMP180* bmp, uint32_t period_us);
+	void start(uint32_t now_us);
+	bool poll(uint32_t now_us);
+	uint32_t get_next_us();
+	BMP180* get_bmp();
+	uint32_t get_period_us();
+
+	// Timing statistics
+	uint32_t get_jitter_us();
+	uint32_t get_missed();
+	void reset_stats();
+
+protected:
+
+	// Scheduler states
+	typedef enum
+	{
+		state_idle,	// Waiting for next pressure deadline
+		state_pres,	// Pressure conversion running
+		state_temp,	// Temperature conversion running
+	}
+	state_t;
+
+	// Sensor and timing
+	BMP180* bmp;
+	uint32_t period_us;
+	uint32_t deadline_us;
+	uint32_t ready_us;
+	state_t state;
+
+	// Temperature refresh
+	static const uint8_t temp_late_max = 4;
+	uint8_t temp_late;
+
+	// Statistics
+	uint32_t jitter_us;
+	uint32_t missed;
+
+	static bool reached(uint32_t now_us, uint32_t time_us);
+};
@@ -0,0 +1,104 @@
+/**
+ * @file BMP180Track.cpp
+ */
+#include "BMP180Track.h"
+
+/**
+ * @brief Constructs temperature tracker
+ * @param extrap True to extrapolate temperature to each pressure reading
+ * 
+ * Attach as the track entry of BMP180::set_companions(). The temperature
+ * age limit used by BMP180::temp_due() then adapts to drift: it halves
+ * each time a refresh finds UT moved by more than drift_ut codes (roughly
+ * 5 Pa of stale-temperature pressure error on typical parts) and doubles
+ * back up to the sensor's temp_age_max setting while it moves by no more
+ * than still_ut codes.
+ */
+BMP180Track::BMP180Track(bool extrap)
+{
+	this->age_limit = 0xFFFF;
+	this->extrap = extrap;
+	this->span = 0;
+	this->b5_slope = 0;
+}
+
+/**
+ * @brief Enables extrapolation of temperature to each pressure reading
+ * @param enable True to enable
+ * 
+ * The rate of change of temperature per pressure sample is measured
+ * between the last two temperature readings, and each pressure reading is
+ * compensated with the temperature projected forward by its age. This
+ * removes most of the stale-temperature error under a steady drift, so
+ * temperature can be read less often. Projection never extends further
+ * than the interval the rate was measured over.
+ */
+void BMP180Track::set_extrap(bool enable)
+{
+	extrap = enable;
+}
+
+/**
+ * @brief Updates tracker with a new temperature reading
+ * @param ut_delta Change in UT since last reading
+ * @param b5_delta Change in B5 since last reading
+ * @param age Pressure samples since last reading (0 if none)
+ * @param age_max Maximum age limit
+ * 
+ * Called by the BMP180 on each temperature reading. Costs one division
+ * while temperature is changing.
+ */
+void BMP180Track::update(int32_t ut_delta, int32_t b5_delta, uint16_t age, uint16_t age_max)
+{
+	// Adapt age limit to drift
+	if (age_limit > age_max) { age_limit = age_max; }
+	if (age > 0)
+	{
+		int32_t d = (ut_delta > 0) ? ut_delta : -ut_delta;
+		if (d > drift_ut)
+		{
+			age_limit = (age_limit > 1) ? (age_limit >> 1) : 1;
+		}
+		else if (d <= still_ut && age_limit < age_max)
+		{
+			age_limit = (age_limit <= (age_max >> 1)) ? (age_limit << 1) : age_max;
+		}
+	}
+
+	// Track rate of change per pressure sample
+	span = age;
+	b5_slope = (age > 0) ? (b5_delta * (int32_t)256) / age : 0;
+}
+
+/**
+ * @brief Returns temperature age limit in force [pressure samples]
+ * @param age_max Maximum age limit
+ */
+uint16_t BMP180Track::get_age_limit(uint16_t age_max)
+{
+	return (age_limit < age_max) ? age_limit : age_max;
+}
+
+/**
+ * @brief Returns extrapolated change in B5 since last temperature reading
+ * @param age Pressure samples since last temperature reading
+ */
+int32_t BMP180Track::get_b5_offset(uint16_t age)
+{
+	if (!extrap) { return 0; }
+	uint16_t n = (age < span) ? age : span;
+	return (b5_slope * n) >> 8;
+}
+
+/**
+ * @brief Returns extrapolated change in temperature since last reading [deg C]
+ * @param age Pressure samples since last temperature reading
+ * 
+ * Skips the integer rounding of get_b5_offset() for float builds.
+ */
+float BMP180Track::get_temp_offset(uint16_t age)
+{
+	if (!extrap) { return 0.0f; }
+	uint16_t n = (age < span) ? age : span;
+	return (float)(b5_slope * n) * (1.0f / (256 * b5_per_deg));
+}
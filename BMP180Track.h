@@ -0,0 +1,41 @@
+/**
+ * @file BMP180Track.h
+ * @brief Optional temperature drift tracking for BMP180 streaming
+ */
+#pragma once
+#include <stdint.h>
+
+/**
+ * Class Declaration
+ */
+class BMP180Track
+{
+public:
+
+	// Temperature term scale [B5 units / deg C]
+	static const int32_t b5_per_deg = 160;
+
+	// Constructor and basics
+	BMP180Track(bool extrap = false);
+	void set_extrap(bool enable);
+	void update(int32_t ut_delta, int32_t b5_delta, uint16_t age, uint16_t age_max);
+
+	// Outputs
+	uint16_t get_age_limit(uint16_t age_max);
+	int32_t get_b5_offset(uint16_t age);
+	float get_temp_offset(uint16_t age);
+
+protected:
+
+	// Drift thresholds [UT codes]
+	static const int32_t drift_ut = 4;
+	static const int32_t still_ut = 1;
+
+	// Adaptive age limit
+	uint16_t age_limit;
+
+	// Extrapolation
+	bool extrap;
+	uint16_t span;
+	int32_t b5_slope;	// B5 units / 256 per pressure sample
+};
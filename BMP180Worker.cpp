@@ -0,0 +1,132 @@
+/**
+ * @file BMP180Worker.cpp
+ */
+#include "BMP180Worker.h"
+
+/**
+ * @brief Constructs acquisition worker for the sensors on one bus
+ * @param scheds Array of schedulers, one per sensor on the bus
+ * @param queues Array of queues, one per scheduler (NULL entries skipped)
+ * @param count Number of schedulers
+ * @param now Function returning current time [us]
+ * @param wait Function sleeping for the given time [us], or NULL to spin
+ * @param wait_arg Context pointer passed to wait
+ * 
+ * Each worker owns its sensors, their schedulers and the producer side of
+ * their queues, and shares nothing with other workers. Create one per
+ * physical bus, call start(), then call run() from a thread of its own
+ * (pthread, RTOS task, etc); throughput then scales with the number of
+ * buses. Consumers pop samples from the queues on any other thread.
+ */
+BMP180Worker::BMP180Worker(BMP180Scheduler** scheds, BMP180Queue** queues, uint8_t count, now_t now, BMP180::wait_t wait, void* wait_arg) :
+	loop(scheds, count, publish, this)
+{
+	this->scheds = scheds;
+	this->queues = queues;
+	this->now = now;
+	this->wait = wait;
+	this->wait_arg = wait_arg;
+	this->start_hook = NULL;
+	this->start_arg = NULL;
+	this->running = false;
+	this->published = 0;
+}
+
+/**
+ * @brief Sets function run on the worker thread before sampling starts
+ * @param hook Hook function, or NULL for none
+ * @param arg Context pointer passed to hook
+ * 
+ * Use it to pin the thread to a core or raise its priority, e.g. with
+ * pthread_setaffinity_np() on Linux.
+ */
+void BMP180Worker::set_start_hook(hook_t hook, void* arg)
+{
+	this->start_hook = hook;
+	this->start_arg = arg;
+}
+
+/**
+ * @brief Arms worker for run()
+ * 
+ * Call before creating the worker thread, so a stop() issued before the
+ * thread reaches run() is never lost.
+ */
+void BMP180Worker::start()
+{
+	running = true;
+}
+
+/**
+ * @brief Runs acquisition until stop() is called
+ * 
+ * Body for the worker thread. Returns at once unless start() was called
+ * and no stop() followed. Starts all schedulers, then sleeps with the
+ * wait function until the earliest scheduler deadline and services the
+ * sensors that are due.
+ */
+void BMP180Worker::run()
+{
+	if (!running) { return; }
+	if (start_hook) { start_hook(start_arg); }
+	loop.start(now());
+	while (running)
+	{
+		uint32_t next_us = poll(now());
+		int32_t sleep_us = (int32_t)(next_us - now());
+		if (sleep_us > 0 && wait) { wait(wait_arg, (uint32_t)sleep_us); }
+	}
+}
+
+/**
+ * @brief Asks run() to return (safe from any thread)
+ * 
+ * run() returns after its current sleep.
+ */
+void BMP180Worker::stop()
+{
+	running = false;
+}
+
+/**
+ * @brief Returns true from start() until stop()
+ */
+bool BMP180Worker::is_running()
+{
+	return running;
+}
+
+/**
+ * @brief Services due sensors once and publishes new samples
+ * @param now_us Current time [us]
+ * @return Earliest time any sensor next has work to do [us]
+ * 
+ * Lets a caller drive the worker from its own loop instead of run().
+ */
+uint32_t BMP180Worker::poll(uint32_t now_us)
+{
+	return loop.poll(now_us);
+}
+
+/**
+ * @brief Returns number of samples published to queues
+ */
+uint32_t BMP180Worker::get_published()
+{
+	return published;
+}
+
+/**
+ * @brief Loop callback pushing a new sample to its sensor's queue
+ * @param arg Worker
+ * @param index Scheduler index
+ */
+void BMP180Worker::publish(void* arg, uint8_t index)
+{
+	BMP180Worker* worker = (BMP180Worker*)arg;
+	BMP180Queue* queue = worker->queues[index];
+	if (queue && queue->push(worker->scheds[index]->get_bmp()->get_sample()))
+	{
+		worker->published++;
+	}
+}
@@ -0,0 +1,51 @@
+/**
+ * @file BMP180Worker.h
+ * @brief Per-bus acquisition worker publishing BMP180 samples to queues
+ */
+#pragma once
+#include "BMP180Loop.h"
+#include "BMP180Queue.h"
+
+/**
+ * Class Declaration
+ */
+class BMP180Worker
+{
+public:
+
+	// Platform hooks
+	typedef uint32_t (*now_t)();	// Returns current time [us]
+	typedef void (*hook_t)(void* arg);	// Runs on the worker thread
+
+	// Constructor and basics
+	BMP180Worker(BMP180Scheduler** scheds, BMP180Queue** queues, uint8_t count, now_t now, BMP180::wait_t wait = NULL, void* wait_arg = NULL);
+	void set_start_hook(hook_t hook, void* arg = NULL);
+	void start();
+	void run();
+	void stop();
+	bool is_running();
+	uint32_t poll(uint32_t now_us);
+
+	// Counters
+	uint32_t get_published();
+
+protected:
+
+	// Sensors and queues
+	BMP180Scheduler** scheds;
+	BMP180Queue** queues;
+	BMP180Loop loop;
+
+	// Platform hooks
+	now_t now;
+	BMP180::wait_t wait;
+	void* wait_arg;
+	hook_t start_hook;
+	void* start_arg;
+
+	// State
+	volatile bool running;
+	volatile uint32_t published;
+
+	static void publish(void* arg, uint8_t index);
+};
@@ -0,0 +1,150 @@
+/**
+ * @file BMP180Allan.cpp
+ */
+#include "BMP180Allan.h"
+#include <math.h>
+
+/**
+ * @brief Returns buffer size needed for given number of levels [doubles]
+ * @param levels Number of octave levels (at most max_levels)
+ */
+uint32_t BMP180Allan::get_size(uint8_t levels)
+{
+	return (uint32_t)2 << levels;
+}
+
+/**
+ * @brief Constructs Allan deviation accumulator
+ * @param buffer Storage of get_size(levels) doubles owned by caller
+ * @param levels Number of octave levels (at most max_levels)
+ * @param tau0 Sample period [s]
+ * 
+ * Computes the overlapping Allan deviation at tau = tau0 * 2^n for
+ * n < levels. Every sample contributes one term per level from the phase
+ * (running sum) 2^n and 2^(n+1) samples back, so memory is set by the
+ * longest tau and not by the recording length; hours or days of data can
+ * be streamed from disk. 20 levels at 100 Hz reach tau of about 1.5 hours
+ * with a 16 MB buffer.
+ */
+BMP180Allan::BMP180Allan(double* buffer, uint8_t levels, float tau0)
+{
+	if (levels > max_levels) { levels = max_levels; }
+	this->phase = buffer;
+	this->mask = get_size(levels) - 1;
+	this->levels = levels;
+	this->tau0 = tau0;
+	reset();
+}
+
+/**
+ * @brief Adds one sample
+ * @param x Sample (e.g. pressure [kPa])
+ */
+void BMP180Allan::add(float x)
+{
+	// Work relative to first sample to keep float resolution
+	if (!has_ref)
+	{
+		ref = x;
+		has_ref = true;
+	}
+	sum += x - ref;
+	count++;
+	phase[count & mask] = sum;
+
+	// Second difference of phase at each averaging time
+	for (uint8_t i = 0; i < levels; i++)
+	{
+		uint32_t m = (uint32_t)1 << i;
+		if (count < 2 * m) { break; }
+		double d = sum - 2.0 * phase[(count - m) & mask] + phase[(count - 2 * m) & mask];
+		sum_sq[i] += d * d;
+		terms[i]++;
+	}
+}
+
+/**
+ * @brief Adds one raw sample using the driver's integer compensation
+ * @param cal Calibration coefficients of the recorded sensor
+ * @param ut Uncompensated temperature
+ * @param up Uncompensated pressure
+ * @param oss Oversampling setting (0-3)
+ */
+void BMP180Allan::add_raw(const BMP180::cal_t& cal, int32_t ut, uint32_t up, uint8_t oss)
+{
+	int32_t b5 = BMP180::comp_b5(cal, ut);
+	add(BMP180::comp_pres(cal, b5, up, oss) * 0.001f);
+}
+
+/**
+ * @brief Clears all accumulated data
+ */
+void BMP180Allan::reset()
+{
+	count = 0;
+	sum = 0.0;
+	phase[0] = 0.0;
+	ref = 0.0f;
+	has_ref = false;
+	for (uint8_t i = 0; i < max_levels; i++)
+	{
+		sum_sq[i] = 0.0;
+		terms[i] = 0;
+	}
+}
+
+/**
+ * @brief Returns number of levels with at least one term
+ */
+uint8_t BMP180Allan::get_levels()
+{
+	uint8_t n = 0;
+	while (n < levels && terms[n] > 0) { n++; }
+	return n;
+}
+
+/**
+ * @brief Returns averaging time of level [s]
+ * @param level Octave level
+ */
+float BMP180Allan::get_tau(uint8_t level)
+{
+	return ldexpf(tau0, level);
+}
+
+/**
+ * @brief Returns Allan deviation at level [sample units]
+ * @param level Octave level
+ */
+float BMP180Allan::get_adev(uint8_t level)
+{
+	if (level >= levels || terms[level] == 0) { return 0.0f; }
+	double m = ldexp(1.0, level);
+	return (float)sqrt(sum_sq[level] / (2.0 * m * m * terms[level]));
+}
+
+/**
+ * @brief Returns number of overlapping terms averaged at level
+ * @param level Octave level
+ */
+uint32_t BMP180Allan::get_terms(uint8_t level)
+{
+	return (level < levels) ? terms[level] : 0;
+}
+
+/**
+ * @brief Returns averaging time with lowest Allan deviation [s]
+ * 
+ * Only levels with at least opt_min_terms terms are considered, to avoid
+ * picking a minimum that is just estimation noise. Returns 0 if no level
+ * has enough.
+ */
+float BMP180Allan::get_opt_tau()
+{
+	int8_t best = -1;
+	for (uint8_t i = 0; i < levels && terms[i] >= opt_min_terms; i++)
+	{
+		if (best < 0 || get_adev(i) < get_adev(best)) { best = i; }
+	}
+	return (best < 0) ? 0.0f : get_tau(best);
+}
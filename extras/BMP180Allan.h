@@ -0,0 +1,50 @@
+/**
+ * @file BMP180Allan.h
+ * @brief Overlapping Allan deviation of BMP180 pressure recordings
+ */
+#pragma once
+#include "../BMP180.h"
+
+/**
+ * Class Declaration
+ */
+class BMP180Allan
+{
+public:
+
+	// Octave levels (tau = tau0 * 2^level)
+	static const uint8_t max_levels = 30;
+
+	// Constructor and basics
+	static uint32_t get_size(uint8_t levels);
+	BMP180Allan(double* buffer, uint8_t levels, float tau0);
+	void add(float x);
+	void add_raw(const BMP180::cal_t& cal, int32_t ut, uint32_t up, uint8_t oss);
+	void reset();
+
+	// Results
+	uint8_t get_levels();
+	float get_tau(uint8_t level);
+	float get_adev(uint8_t level);
+	uint32_t get_terms(uint8_t level);
+	float get_opt_tau();
+
+protected:
+
+	// Phase history (cumulative sums of samples)
+	double* phase;
+	uint32_t mask;
+	uint32_t count;
+	double sum;
+
+	// Samples are taken relative to the first one
+	float ref;
+	bool has_ref;
+
+	// Per-level accumulators
+	static const uint32_t opt_min_terms = 8;
+	uint8_t levels;
+	float tau0;
+	double sum_sq[max_levels];
+	uint32_t terms[max_levels];
+};
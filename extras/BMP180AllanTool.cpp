@@ -0,0 +1,81 @@
+/**
+ * @file BMP180AllanTool.cpp
+ * @brief Host tool computing Allan deviation of raw BMP180 recordings
+ *
+ * Build on a host with the driver dependencies on the include path, e.g.:
+ * g++ -O2 -std=c++11 -I<deps> extras/BMP180AllanTool.cpp
+ *     extras/BMP180Allan.cpp BMP180.cpp BMP180Cache.cpp BMP180Track.cpp
+ *     BMP180Filter.cpp BMP180Alt.cpp -o bmp180_allan
+ *
+ * Usage: bmp180_allan tau0 oss [levels] < recording.txt
+ *
+ * The recording starts with the 11 calibration coefficients (AC1-AC6,
+ * B1, B2, MB, MC, MD) followed by one "UT UP" pair per line, all taken
+ * at the given oversampling setting. Run once per oversampling setting
+ * to compare them.
+ */
+#include "BMP180Allan.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * @brief Reads recording from stdin and prints Allan deviation per tau
+ */
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		fprintf(stderr, "Usage: %s tau0 oss [levels] < recording.txt\n", argv[0]);
+		return 2;
+	}
+	float tau0 = (float)atof(argv[1]);
+	uint8_t oss = (uint8_t)atoi(argv[2]);
+	uint8_t levels = (argc > 3) ? (uint8_t)atoi(argv[3]) : 20;
+	if (levels > BMP180Allan::max_levels) { levels = BMP180Allan::max_levels; }
+
+	// Read calibration
+	long c[11];
+	for (uint8_t i = 0; i < 11; i++)
+	{
+		if (scanf("%ld", &c[i]) != 1)
+		{
+			fprintf(stderr, "Missing calibration coefficients\n");
+			return 1;
+		}
+	}
+	BMP180::cal_t cal;
+	cal.ac1 = (int16_t)c[0];
+	cal.ac2 = (int16_t)c[1];
+	cal.ac3 = (int16_t)c[2];
+	cal.ac4 = (uint16_t)c[3];
+	cal.ac5 = (uint16_t)c[4];
+	cal.ac6 = (uint16_t)c[5];
+	cal.b1 = (int16_t)c[6];
+	cal.b2 = (int16_t)c[7];
+	cal.mb = (int16_t)c[8];
+	cal.mc = (int16_t)c[9];
+	cal.md = (int16_t)c[10];
+
+	// Stream samples
+	double* buffer = new double[BMP180Allan::get_size(levels)];
+	BMP180Allan allan(buffer, levels, tau0);
+	long ut;
+	unsigned long up;
+	unsigned long samples = 0;
+	while (scanf("%ld %lu", &ut, &up) == 2)
+	{
+		allan.add_raw(cal, (int32_t)ut, (uint32_t)up, oss);
+		samples++;
+	}
+
+	// Report
+	printf("# %lu samples, oss %u, overlapping Allan deviation\n", samples, oss);
+	printf("# tau [s]    adev [Pa]    terms\n");
+	for (uint8_t i = 0; i < allan.get_levels(); i++)
+	{
+		printf("%10.3f  %11.4f  %8u\n", allan.get_tau(i), allan.get_adev(i) * 1000.0f, allan.get_terms(i));
+	}
+	printf("# optimal tau %.3f s\n", allan.get_opt_tau());
+	delete[] buffer;
+	return 0;
+}
@@ -0,0 +1,241 @@
+/**
+ * @file BMP180Check.cpp
+ */
+#include "BMP180Check.h"
+#include <math.h>
+
+/**
+ * @brief Computes B5 with 64-bit signed intermediates
+ * @param cal Calibration coefficients
+ * @param ut Uncompensated temperature
+ */
+int32_t BMP180Check::ref_b5(const BMP180::cal_t& cal, int32_t ut)
+{
+	int64_t x1, x2;
+	x1 = ((int64_t)(ut - (int64_t)cal.ac6) * (int64_t)cal.ac5) >> 15;
+	if (x1 + cal.md == 0) { return 0x7FFFFFFF; }
+	x2 = ((int64_t)cal.mc << 11) / (x1 + cal.md);
+	return (int32_t)(x1 + x2);
+}
+
+/**
+ * @brief Computes pressure [Pa] with 64-bit signed intermediates
+ * @param cal Calibration coefficients
+ * @param b5 Temperature compensation term
+ * @param up Uncompensated pressure
+ * @param oss Oversampling setting (0-3)
+ * 
+ * Follows the datasheet algorithm, including its rounding, but without
+ * any intermediate able to overflow.
+ */
+int32_t BMP180Check::ref_pres(const BMP180::cal_t& cal, int32_t b5, uint32_t up, uint8_t oss)
+{
+	int64_t b6, x1, x2, x3, b3, b4, b7, p;
+	b6 = (int64_t)b5 - 4000;
+	x1 = (cal.b2 * ((b6 * b6) >> 12)) >> 11;
+	x2 = (cal.ac2 * b6) >> 11;
+	x3 = x1 + x2;
+	b3 = ((((int64_t)cal.ac1 * 4 + x3) << oss) + 2) >> 2;
+	x1 = (cal.ac3 * b6) >> 13;
+	x2 = (cal.b1 * ((b6 * b6) >> 12)) >> 16;
+	x3 = ((x1 + x2) + 2) >> 2;
+	b4 = ((int64_t)cal.ac4 * (x3 + 32768)) >> 15;
+	if (b4 == 0) { return 0x7FFFFFFF; }
+	b7 = ((int64_t)up - b3) * (50000 >> oss);
+	if (b7 < 0x80000000LL) { p = (b7 * 2) / b4; }
+	else { p = (b7 / b4) * 2; }
+	x1 = p >> 8;
+	x1 = x1 * x1;
+	x1 = (x1 * 3038) >> 16;
+	x2 = (-7357 * p) >> 16;
+	return (int32_t)(p + ((x1 + x2 + 3791) >> 4));
+}
+
+/**
+ * @brief Zeroes sweep result
+ */
+void BMP180Check::clear(result_t& result)
+{
+	result.count = 0;
+	result.temp_errs = 0;
+	result.pres_errs = 0;
+	result.range_errs = 0;
+	result.worst_err = 0;
+	result.worst_ut = 0;
+	result.worst_up = 0;
+	result.float_pres_err = 0.0f;
+	result.float_temp_err = 0.0f;
+}
+
+/**
+ * @brief Compares driver kernels (direct and reciprocal) against reference
+ * @param cal Calibration coefficients
+ * @param oss Oversampling setting (0-3)
+ * @param ut_lo First UT
+ * @param ut_hi Last UT
+ * @param ut_step UT grid step
+ * @param up_step UP grid step (full UP range at this OSS)
+ * @param result Result to accumulate into
+ * 
+ * Inside the operating range, and above the B5 divisor singularity where
+ * real parts read, the float kernel is also compared against the integer
+ * one. Sweeps share no state, so a full sweep can be split
+ * into UT ranges run on separate threads and the results summed (see
+ * BMP180CheckTool.cpp).
+ */
+void BMP180Check::sweep(const BMP180::cal_t& cal, uint8_t oss,
+	int32_t ut_lo, int32_t ut_hi, uint32_t ut_step, uint32_t up_step,
+	result_t& result)
+{
+	uint32_t up_max = (0x10000UL << oss) - 1;
+	BMP180::fcal_t fcal;
+	BMP180::init_fcal(cal, fcal);
+	for (int32_t ut = ut_lo; ut <= ut_hi; ut += ut_step)
+	{
+		// Temperature (skip divide-by-zero in either kernel)
+		int32_t b5 = ref_b5(cal, ut);
+		if (b5 == 0x7FFFFFFF) { continue; }
+		int32_t d = (((ut - (int32_t)cal.ac6) * (int32_t)cal.ac5) >> 15) + cal.md;
+		if (d == 0) { continue; }
+		if (BMP180::comp_b5(cal, ut) != b5) { result.temp_errs++; }
+		int32_t t = BMP180::comp_temp(b5);
+		bool t_in_range = (t >= temp_min) && (t <= temp_max);
+
+		// Float kernel only on the branch real parts read (see inv_temp())
+		bool f_in_range = t_in_range && d > 0;
+		float temp_f = BMP180::comp_temp_float(fcal, ut);
+		if (f_in_range)
+		{
+			float err_f = fabsf(temp_f - t * 0.1f);
+			if (err_f > result.float_temp_err) { result.float_temp_err = err_f; }
+		}
+		int32_t b3 = BMP180::comp_b3(cal, b5, oss);
+		uint32_t b4 = BMP180::comp_b4(cal, b5);
+		uint32_t b4_inv = BMP180::comp_b4_inv(b4);
+
+		// Pressure
+		for (uint32_t up = 0; up <= up_max; up += up_step)
+		{
+			int32_t ref = ref_pres(cal, b5, up, oss);
+			if (f_in_range && ref >= pres_min && ref <= pres_max)
+			{
+				float err_f = fabsf(BMP180::comp_pres_float(fcal, temp_f, up, oss) * 1000.0f - ref);
+				if (err_f > result.float_pres_err) { result.float_pres_err = err_f; }
+			}
+			int32_t err = BMP180::comp_pres(cal, b5, up, oss) - ref;
+			if (err == 0) { err = BMP180::comp_pres(b3, b4, b4_inv, up, oss) - ref; }
+			if (err < 0) { err = -err; }
+			result.count++;
+			if (err == 0) { continue; }
+			result.pres_errs++;
+			if (t_in_range && ref >= pres_min && ref <= pres_max) { result.range_errs++; }
+			if (err > result.worst_err)
+			{
+				result.worst_err = err;
+				result.worst_ut = ut;
+				result.worst_up = up;
+			}
+		}
+	}
+}
+
+/**
+ * @brief Returns grid points of a sweep per calibration at all OSS
+ * @param ut_step UT grid step
+ * @param up_step UP grid step
+ * 
+ * Counts the singular UT codes that sweep() skips, so it can be compared
+ * with get_space().
+ */
+uint64_t BMP180Check::get_points(uint32_t ut_step, uint32_t up_step)
+{
+	uint64_t points = 0;
+	uint64_t ut_points = 0xFFFF / ut_step + 1;
+	for (uint8_t oss = 0; oss < 4; oss++)
+	{
+		uint32_t up_max = (0x10000UL << oss) - 1;
+		points += ut_points * (up_max / up_step + 1);
+	}
+	return points;
+}
+
+/**
+ * @brief Returns UT/UP codes per calibration at all OSS
+ * 
+ * Equal to get_points(1, 1), i.e. an exhaustive sweep.
+ */
+uint64_t BMP180Check::get_space()
+{
+	return get_points(1, 1);
+}
+
+/**
+ * @brief Generates random calibration set around a base set
+ * @param base Base calibration (e.g. a real sensor's)
+ * @param seed Random state (nonzero), advanced on return
+ * @param cal Output calibration
+ * 
+ * Each coefficient is scaled by a random factor in [0.75, 1.25] and
+ * clamped to its 16-bit EEPROM range.
+ */
+void BMP180Check::random_cal(const BMP180::cal_t& base, uint32_t& seed, BMP180::cal_t& cal)
+{
+	cal.ac1 = (int16_t)perturb(base.ac1, -32768, 32767, seed);
+	cal.ac2 = (int16_t)perturb(base.ac2, -32768, 32767, seed);
+	cal.ac3 = (int16_t)perturb(base.ac3, -32768, 32767, seed);
+	cal.ac4 = (uint16_t)perturb(base.ac4, 1, 65535, seed);
+	cal.ac5 = (uint16_t)perturb(base.ac5, 1, 65535, seed);
+	cal.ac6 = (uint16_t)perturb(base.ac6, 1, 65535, seed);
+	cal.b1 = (int16_t)perturb(base.b1, -32768, 32767, seed);
+	cal.b2 = (int16_t)perturb(base.b2, -32768, 32767, seed);
+	cal.mb = (int16_t)perturb(base.mb, -32768, 32767, seed);
+	cal.mc = (int16_t)perturb(base.mc, -32768, 32767, seed);
+	cal.md = (int16_t)perturb(base.md, -32768, 32767, seed);
+}
+
+/**
+ * @brief Reads one calibration set from a text file
+ * @param file Open file
+ * @param cal Output calibration
+ * @return False at end of file or on a malformed set
+ * 
+ * Reads the 11 coefficients AC1-AC6, B1, B2, MB, MC, MD separated by
+ * whitespace, the same format that starts a BMP180AllanTool recording.
+ * Call repeatedly to read a file of many sensors' calibrations.
+ */
+bool BMP180Check::read_cal(FILE* file, BMP180::cal_t& cal)
+{
+	long c[11];
+	for (uint8_t i = 0; i < 11; i++)
+	{
+		if (fscanf(file, "%ld", &c[i]) != 1) { return false; }
+	}
+	cal.ac1 = (int16_t)c[0];
+	cal.ac2 = (int16_t)c[1];
+	cal.ac3 = (int16_t)c[2];
+	cal.ac4 = (uint16_t)c[3];
+	cal.ac5 = (uint16_t)c[4];
+	cal.ac6 = (uint16_t)c[5];
+	cal.b1 = (int16_t)c[6];
+	cal.b2 = (int16_t)c[7];
+	cal.mb = (int16_t)c[8];
+	cal.mc = (int16_t)c[9];
+	cal.md = (int16_t)c[10];
+	return true;
+}
+
+/**
+ * @brief Scales value by random factor in [0.75, 1.25] and clamps it
+ * @param value Base value
+ * @param lo Minimum result
+ * @param hi Maximum result
+ * @param seed Random state (nonzero), advanced on return
+ */
+int32_t BMP180Check::perturb(int32_t value, int32_t lo, int32_t hi, uint32_t& seed)
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	value = (value * (768 + (int32_t)(seed & 511))) >> 10;
+	return (value < lo) ? lo : (value > hi) ? hi : value;
+}
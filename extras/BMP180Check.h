@@ -0,0 +1,53 @@
+/**
+ * @file BMP180Check.h
+ * @brief Overflow and accuracy sweep of the BMP180 integer compensation
+ */
+#pragma once
+#include "../BMP180.h"
+#include <stdio.h>
+
+/**
+ * Class Declaration
+ */
+class BMP180Check
+{
+public:
+
+	// Sweep result
+	typedef struct
+	{
+		uint64_t count;		// Points compared
+		uint32_t temp_errs;	// Temperature mismatches
+		uint64_t pres_errs;	// Pressure mismatches
+		uint64_t range_errs;	// Pressure mismatches in operating range
+		int32_t worst_err;	// Largest pressure error [Pa]
+		int32_t worst_ut;	// UT of largest error
+		uint32_t worst_up;	// UP of largest error
+		float float_pres_err;	// Largest float pressure error in range [Pa]
+		float float_temp_err;	// Largest float temperature error in range [deg C]
+	}
+	result_t;
+
+	// Operating range
+	static const int32_t temp_min = -400;	// [0.1 deg C]
+	static const int32_t temp_max = 850;	// [0.1 deg C]
+	static const int32_t pres_min = 30000;	// [Pa]
+	static const int32_t pres_max = 110000;	// [Pa]
+
+	// 64-bit reference kernel
+	static int32_t ref_b5(const BMP180::cal_t& cal, int32_t ut);
+	static int32_t ref_pres(const BMP180::cal_t& cal, int32_t b5, uint32_t up, uint8_t oss);
+
+	// Sweeps
+	static void clear(result_t& result);
+	static void sweep(const BMP180::cal_t& cal, uint8_t oss,
+		int32_t ut_lo, int32_t ut_hi, uint32_t ut_step, uint32_t up_step,
+		result_t& result);
+	static uint64_t get_points(uint32_t ut_step, uint32_t up_step);
+	static uint64_t get_space();
+	static void random_cal(const BMP180::cal_t& base, uint32_t& seed, BMP180::cal_t& cal);
+	static bool read_cal(FILE* file, BMP180::cal_t& cal);
+
+protected:
+	static int32_t perturb(int32_t value, int32_t lo, int32_t hi, uint32_t& seed);
+};
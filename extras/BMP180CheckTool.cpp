@@ -0,0 +1,287 @@
+/**
+ * @file BMP180CheckTool.cpp
+ * @brief Host tool sweeping and benchmarking the BMP180 compensation
+ *
+ * Build on a host with the driver dependencies on the include path, e.g.:
+ * g++ -O2 -std=c++11 -pthread -I<deps> extras/BMP180CheckTool.cpp
+ *     extras/BMP180Check.cpp BMP180.cpp BMP180Cache.cpp BMP180Track.cpp
+ *     BMP180Filter.cpp BMP180Alt.cpp -o bmp180_check
+ *
+ * Usage: bmp180_check [threads] [random calibrations] [ut_step] [up_step]
+ *     [calibration file]
+ *
+ * Sweeps the datasheet calibration, every calibration set in the file
+ * (11 coefficients each, as at the start of a BMP180AllanTool recording)
+ * and the given number of random sets around the datasheet one. The UT
+ * and UP grid steps default to 31, about 1/961 of the space; steps of 1
+ * sweep it exhaustively, which takes hours per calibration.
+ */
+#include "BMP180Check.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+/**
+ * Datasheet Example Calibration
+ */
+static const BMP180::cal_t datasheet_cal =
+	{ 408, -72, -14383, 32741, 32757, 23153, 6190, 4, -32768, -8711, 2868 };
+
+/**
+ * Sweep and Benchmark Parameters
+ */
+static const uint32_t step_default = 31;
+static const uint32_t step_max = 0xFFFF;
+static const uint32_t bench_points = 1 << 16;
+static const uint32_t bench_passes = 64;
+
+/**
+ * Compensation Variants
+ */
+typedef enum
+{
+	variant_ref,	// 64-bit reference kernel
+	variant_full,	// Driver kernel from calibration
+	variant_cached,	// Driver kernel from cached B3, B4 and reciprocal
+	variant_float,	// Single-precision kernel
+	variant_count,
+}
+variant_t;
+
+static const char* variant_names[variant_count] =
+	{ "reference", "integer", "integer cached", "float" };
+
+/**
+ * @brief Returns wall-clock time [s]
+ */
+static double now_s()
+{
+	using namespace std::chrono;
+	return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Sweeps one calibration at all OSS, splitting UT across threads
+ * @param cal Calibration coefficients
+ * @param threads Number of threads
+ * @param ut_step UT grid step
+ * @param up_step UP grid step
+ * @param total Result to accumulate into
+ */
+static void sweep_cal(const BMP180::cal_t& cal, uint32_t threads,
+	uint32_t ut_step, uint32_t up_step, BMP180Check::result_t& total)
+{
+	std::vector<BMP180Check::result_t> results(threads);
+	std::vector<std::thread> workers;
+	for (uint32_t i = 0; i < threads; i++)
+	{
+		BMP180Check::clear(results[i]);
+		workers.push_back(std::thread([&cal, &results, i, threads, ut_step, up_step]()
+		{
+			// Interleave UT grid rows across threads
+			int32_t lo = (int32_t)(i * ut_step);
+			for (uint8_t oss = 0; oss < 4; oss++)
+			{
+				BMP180Check::sweep(cal, oss, lo, 0xFFFF,
+					threads * ut_step, up_step, results[i]);
+			}
+		}));
+	}
+	for (uint32_t i = 0; i < threads; i++)
+	{
+		workers[i].join();
+		const BMP180Check::result_t& r = results[i];
+		total.count += r.count;
+		total.temp_errs += r.temp_errs;
+		total.pres_errs += r.pres_errs;
+		total.range_errs += r.range_errs;
+		if (r.worst_err > total.worst_err)
+		{
+			total.worst_err = r.worst_err;
+			total.worst_ut = r.worst_ut;
+			total.worst_up = r.worst_up;
+		}
+		if (r.float_pres_err > total.float_pres_err) { total.float_pres_err = r.float_pres_err; }
+		if (r.float_temp_err > total.float_temp_err) { total.float_temp_err = r.float_temp_err; }
+	}
+}
+
+/**
+ * @brief Runs one variant over the benchmark points
+ * @param variant Compensation variant
+ * @param cal Calibration coefficients
+ * @param ut UT per point
+ * @param up UP per point
+ * @return Checksum of results (keeps the work from being optimized out)
+ */
+static int64_t bench_run(variant_t variant, const BMP180::cal_t& cal,
+	const std::vector<int32_t>& ut, const std::vector<uint32_t>& up)
+{
+	BMP180::fcal_t fcal;
+	BMP180::init_fcal(cal, fcal);
+	int64_t sum = 0;
+	for (uint32_t pass = 0; pass < bench_passes; pass++)
+	{
+		for (uint32_t i = 0; i < bench_points; i++)
+		{
+			switch (variant)
+			{
+				case variant_ref:
+				{
+					sum += BMP180Check::ref_pres(cal, BMP180Check::ref_b5(cal, ut[i]), up[i], 3);
+					break;
+				}
+				case variant_full:
+				{
+					sum += BMP180::comp_pres(cal, BMP180::comp_b5(cal, ut[i]), up[i], 3);
+					break;
+				}
+				case variant_cached:
+				{
+					// Points share UT in runs of 64, as between temperature reads
+					int32_t b5 = BMP180::comp_b5(cal, ut[i & ~63UL]);
+					int32_t b3 = BMP180::comp_b3(cal, b5, 3);
+					uint32_t b4 = BMP180::comp_b4(cal, b5);
+					uint32_t b4_inv = BMP180::comp_b4_inv(b4);
+					for (uint32_t j = 0; j < 64; j++)
+					{
+						sum += BMP180::comp_pres(b3, b4, b4_inv, up[i + j], 3);
+					}
+					i += 63;
+					break;
+				}
+				case variant_float:
+				{
+					float temp = BMP180::comp_temp_float(fcal, ut[i]);
+					sum += (int64_t)(BMP180::comp_pres_float(fcal, temp, up[i], 3) * 1000.0f);
+					break;
+				}
+				default:
+					break;
+			}
+		}
+	}
+	return sum;
+}
+
+/**
+ * @brief Times one variant on all threads
+ * @param variant Compensation variant
+ * @param threads Number of threads
+ * @return Total throughput [samples/s]
+ */
+static double bench_variant(variant_t variant, uint32_t threads)
+{
+	// Points spread over the operating range
+	std::vector<int32_t> ut(bench_points);
+	std::vector<uint32_t> up(bench_points);
+	uint32_t seed = 1;
+	for (uint32_t i = 0; i < bench_points; i++)
+	{
+		seed = seed * 1664525 + 1013904223;
+		ut[i] = 24000 + (int32_t)(seed >> 20) * 3;
+		seed = seed * 1664525 + 1013904223;
+		up[i] = 200000 + (seed >> 16) * 4;
+	}
+
+	// Run all threads
+	std::vector<std::thread> workers;
+	std::vector<int64_t> sums(threads);
+	double start = now_s();
+	for (uint32_t i = 0; i < threads; i++)
+	{
+		workers.push_back(std::thread([&, i]()
+		{
+			sums[i] = bench_run(variant, datasheet_cal, ut, up);
+		}));
+	}
+	int64_t check = 0;
+	for (uint32_t i = 0; i < threads; i++)
+	{
+		workers[i].join();
+		check += sums[i];
+	}
+	double elapsed = now_s() - start;
+	if (check == 0) { printf("(empty checksum)\n"); }
+	return (double)threads * bench_passes * bench_points / elapsed;
+}
+
+/**
+ * @brief Parses grid step, clamped to [1, step_max]
+ * @param arg Argument text
+ */
+static uint32_t parse_step(const char* arg)
+{
+	long step = atol(arg);
+	return (step < 1) ? 1 : (step > (long)step_max) ? step_max : (uint32_t)step;
+}
+
+/**
+ * @brief Runs sweeps over datasheet, file and random calibrations, then benchmarks
+ */
+int main(int argc, char** argv)
+{
+	uint32_t threads = std::thread::hardware_concurrency();
+	if (argc > 1) { threads = (uint32_t)atoi(argv[1]); }
+	if (threads == 0) { threads = 1; }
+	uint32_t cals = (argc > 2) ? (uint32_t)atoi(argv[2]) : 16;
+	uint32_t ut_step = (argc > 3) ? parse_step(argv[3]) : step_default;
+	uint32_t up_step = (argc > 4) ? parse_step(argv[4]) : step_default;
+
+	// Calibrations
+	std::vector<BMP180::cal_t> cal_list(1, datasheet_cal);
+	if (argc > 5)
+	{
+		FILE* file = fopen(argv[5], "r");
+		if (file == NULL)
+		{
+			fprintf(stderr, "Cannot open %s\n", argv[5]);
+			return 2;
+		}
+		BMP180::cal_t cal;
+		while (BMP180Check::read_cal(file, cal)) { cal_list.push_back(cal); }
+		fclose(file);
+		printf("Loaded %u calibrations from %s\n", (uint32_t)cal_list.size() - 1, argv[5]);
+	}
+	uint32_t seed = 1;
+	for (uint32_t i = 0; i < cals; i++)
+	{
+		BMP180::cal_t cal;
+		BMP180Check::random_cal(datasheet_cal, seed, cal);
+		cal_list.push_back(cal);
+	}
+
+	// Sweeps
+	uint64_t points = BMP180Check::get_points(ut_step, up_step);
+	uint64_t space = BMP180Check::get_space();
+	printf("Sweeping %u calibrations on %u threads\n", (uint32_t)cal_list.size(), threads);
+	printf("Coverage: UT step %u, UP step %u, %llu of %llu codes per calibration (%.6f)\n",
+		ut_step, up_step, (unsigned long long)points, (unsigned long long)space,
+		(double)points / space);
+	BMP180Check::result_t total;
+	BMP180Check::clear(total);
+	double start = now_s();
+	for (uint32_t i = 0; i < cal_list.size(); i++)
+	{
+		sweep_cal(cal_list[i], threads, ut_step, up_step, total);
+	}
+	printf("Points: %llu in %.2f s\n", (unsigned long long)total.count, now_s() - start);
+	printf("Temperature mismatches: %u\n", total.temp_errs);
+	printf("Pressure mismatches: %llu (%llu in operating range)\n",
+		(unsigned long long)total.pres_errs, (unsigned long long)total.range_errs);
+	printf("Worst error: %d Pa at UT %d UP %u\n", total.worst_err, total.worst_ut, total.worst_up);
+	printf("Float kernel in operating range: within %.2f Pa, %.4f deg C\n",
+		total.float_pres_err, total.float_temp_err);
+
+	// Benchmarks
+	printf("Benchmark (8x oversampling, %u threads):\n", threads);
+	for (uint8_t v = 0; v < variant_count; v++)
+	{
+		double rate = bench_variant((variant_t)v, threads);
+		printf("  %-15s %8.2f Msamples/s  %6.2f ns/sample/thread\n",
+			variant_names[v], rate * 1e-6, threads * 1e9 / rate);
+	}
+	return (total.range_errs == 0 && total.temp_errs == 0) ? 0 : 1;
+}
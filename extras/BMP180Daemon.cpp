@@ -0,0 +1,331 @@
+/**
+ * @file BMP180Daemon.cpp
+ */
+#include "BMP180Daemon.h"
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/**
+ * Field Flags Known to Protocol
+ */
+static const uint8_t fields_all =
+	BMP180Frame::field_seq | BMP180Frame::field_time | BMP180Frame::field_temp |
+	BMP180Frame::field_pres | BMP180Frame::field_raw;
+
+/**
+ * @brief Constructs sensor-owning daemon
+ * @param scheds Array of schedulers, one per sensor, already initialized
+ * @param count Number of schedulers
+ * 
+ * The daemon is the only process touching the buses: it runs the sampling
+ * loop through BMP180Epoll and serves any number of local clients (up to
+ * max_clients) from the same thread, so calibration is read once and
+ * tools never contend for a bus.
+ * 
+ * Clients connect to a SOCK_SEQPACKET Unix socket and send a request_len
+ * byte subscribe request (all values MSB first):
+ * - Protocol version (1 byte)
+ * - Sensor index (1 byte)
+ * - Field flags (1 byte)
+ * - Samples per frame (1 byte)
+ * - Maximum rate [Hz] (2 bytes)
+ * - Decimation (2 bytes)
+ * 
+ * The daemon replies with one status_t byte, then sends one BMP180Frame
+ * per message. A later request replaces the subscription. Frames a slow
+ * client cannot take are dropped whole rather than delaying sampling.
+ * 
+ * Build on a Linux host with the driver dependencies on the include path,
+ * adding the program that opens the buses and builds the schedulers, e.g.:
+ * g++ -O2 -std=c++11 -I<deps> main.cpp extras/BMP180Daemon.cpp
+ *     extras/BMP180Epoll.cpp BMP180Frame.cpp BMP180Loop.cpp
+ *     BMP180Scheduler.cpp BMP180.cpp BMP180Cache.cpp BMP180Track.cpp
+ *     BMP180Filter.cpp BMP180Alt.cpp -o bmp180d
+ */
+BMP180Daemon::BMP180Daemon(BMP180Scheduler** scheds, uint8_t count) :
+	loop(scheds, count, on_sample, this),
+	epoll(&loop)
+{
+	this->scheds = scheds;
+	this->count = count;
+	this->path = NULL;
+	this->listen_watch.fd = -1;
+	this->listen_watch.handler = on_listen;
+	this->listen_watch.arg = this;
+	for (uint8_t i = 0; i < max_clients; i++)
+	{
+		clients[i].daemon = this;
+		clients[i].watch.fd = -1;
+		clients[i].watch.handler = on_client;
+		clients[i].watch.arg = &clients[i];
+		clients[i].frame = NULL;
+	}
+	this->frames_sent = 0;
+	this->frames_dropped = 0;
+}
+
+/**
+ * @brief Closes clients and removes socket file
+ */
+BMP180Daemon::~BMP180Daemon()
+{
+	for (uint8_t i = 0; i < max_clients; i++)
+	{
+		close_client(clients[i]);
+	}
+	if (listen_watch.fd >= 0)
+	{
+		close(listen_watch.fd);
+		unlink(path);
+	}
+}
+
+/**
+ * @brief Creates listening socket and event loop
+ * @param path Socket file path, replaced if present
+ * @return True on success
+ */
+bool BMP180Daemon::init(const char* path)
+{
+	struct sockaddr_un addr;
+	if (strlen(path) >= sizeof(addr.sun_path)) { return false; }
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, path);
+
+	// Listen for clients
+	int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (fd < 0) { return false; }
+	unlink(path);
+	if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, max_clients) != 0)
+	{
+		close(fd);
+		return false;
+	}
+	this->path = path;
+	listen_watch.fd = fd;
+	return epoll.init() && epoll.add(&listen_watch);
+}
+
+/**
+ * @brief Samples and serves clients until stop()
+ */
+void BMP180Daemon::run()
+{
+	epoll.run();
+}
+
+/**
+ * @brief Makes run() return
+ * 
+ * Safe from any thread and from signal handlers.
+ */
+void BMP180Daemon::stop()
+{
+	epoll.stop();
+}
+
+/**
+ * @brief Decodes subscribe request
+ * @param data Request bytes
+ * @param length Request length [bytes]
+ * @param request Decoded request
+ * @return True if the length and version match this protocol
+ */
+bool BMP180Daemon::decode(const uint8_t* data, uint16_t length, request_t& request)
+{
+	if (length != request_len) { return false; }
+	request.version = data[0];
+	request.sensor = data[1];
+	request.fields = data[2];
+	request.batch = data[3];
+	request.rate_hz = (uint16_t)((data[4] << 8) | data[5]);
+	request.decimation = (uint16_t)((data[6] << 8) | data[7]);
+	return request.version == protocol_version;
+}
+
+/**
+ * @brief Returns number of frames sent to clients
+ */
+uint32_t BMP180Daemon::get_frames_sent()
+{
+	return frames_sent;
+}
+
+/**
+ * @brief Returns number of frames dropped for full client sockets
+ */
+uint32_t BMP180Daemon::get_frames_dropped()
+{
+	return frames_dropped;
+}
+
+/**
+ * @brief Accepts new client
+ * @param arg Daemon
+ * @param fd Listening socket
+ * @param events Epoll events
+ */
+void BMP180Daemon::on_listen(void* arg, int fd, uint32_t events)
+{
+	(void)events;
+	BMP180Daemon* daemon = (BMP180Daemon*)arg;
+	int client_fd = accept4(fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+	if (client_fd < 0) { return; }
+
+	// Take free slot
+	for (uint8_t i = 0; i < max_clients; i++)
+	{
+		client_t& client = daemon->clients[i];
+		if (client.watch.fd < 0)
+		{
+			client.watch.fd = client_fd;
+			if (!daemon->epoll.add(&client.watch))
+			{
+				close(client_fd);
+				client.watch.fd = -1;
+			}
+			return;
+		}
+	}
+	reply(client_fd, status_busy);
+	close(client_fd);
+}
+
+/**
+ * @brief Handles subscribe request or hangup
+ * @param arg Client slot
+ * @param fd Client socket
+ * @param events Epoll events
+ */
+void BMP180Daemon::on_client(void* arg, int fd, uint32_t events)
+{
+	(void)events;
+	client_t& client = *(client_t*)arg;
+	uint8_t data[request_len + 1];
+	ssize_t n = recv(fd, data, sizeof(data), MSG_DONTWAIT);
+	if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) { return; }
+	if (n <= 0)
+	{
+		client.daemon->close_client(client);
+		return;
+	}
+	reply(fd, client.daemon->subscribe(client, data, (uint16_t)n));
+}
+
+/**
+ * @brief Adds new sample to subscribed frames
+ * @param arg Daemon
+ * @param index Sensor index
+ */
+void BMP180Daemon::on_sample(void* arg, uint8_t index)
+{
+	BMP180Daemon* daemon = (BMP180Daemon*)arg;
+	BMP180::sample_t sample = daemon->scheds[index]->get_bmp()->get_sample();
+	uint32_t time_us = BMP180Epoll::now_us();
+	for (uint8_t i = 0; i < max_clients; i++)
+	{
+		client_t& client = daemon->clients[i];
+		if (client.frame == NULL || client.sensor != index) { continue; }
+		client.frame->add(sample, time_us);
+		if (client.frame->get_count() >= client.batch || client.frame->is_full())
+		{
+			daemon->send_frame(client);
+		}
+	}
+}
+
+/**
+ * @brief Replaces client subscription
+ * @param client Client slot
+ * @param data Request bytes
+ * @param length Request length [bytes]
+ * @return Reply status
+ * 
+ * The rate limit becomes a decimation of the sensor's own rate, rounded
+ * so the client never gets more than rate_hz samples per second.
+ */
+BMP180Daemon::status_t BMP180Daemon::subscribe(client_t& client, const uint8_t* data, uint16_t length)
+{
+	request_t request;
+	if (!decode(data, length, request) || request.sensor >= count ||
+		(request.fields & fields_all) == 0 || (request.fields & ~fields_all) != 0)
+	{
+		return status_bad_request;
+	}
+
+	// Combine rate limit and decimation
+	uint32_t step = 1;
+	if (request.rate_hz > 0)
+	{
+		uint64_t per_s = (uint64_t)scheds[request.sensor]->get_period_us() * request.rate_hz;
+		if (per_s > 0 && per_s < 1000000) { step = (uint32_t)((1000000 + per_s - 1) / per_s); }
+	}
+	step *= (request.decimation > 0) ? request.decimation : 1;
+	if (step > 0xFFFF) { step = 0xFFFF; }
+
+	// Start new frame
+	delete client.frame;
+	client.sensor = request.sensor;
+	client.batch = (request.batch > 0) ? request.batch : 1;
+	client.frame = new BMP180Frame(client.buffer, frame_size, request.fields, (uint16_t)step, request.sensor);
+	return status_ok;
+}
+
+/**
+ * @brief Sends and clears client frame
+ * @param client Client slot
+ * 
+ * Sequenced packets are sent whole or not at all, so a full socket drops
+ * one frame and the stream stays aligned.
+ */
+void BMP180Daemon::send_frame(client_t& client)
+{
+	ssize_t n = send(client.watch.fd, client.frame->get_data(), client.frame->get_length(), MSG_DONTWAIT | MSG_NOSIGNAL);
+	client.frame->clear();
+	if (n >= 0)
+	{
+		frames_sent++;
+	}
+	else if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS)
+	{
+		frames_dropped++;
+	}
+	else
+	{
+		close_client(client);
+	}
+}
+
+/**
+ * @brief Closes client and frees its slot
+ * @param client Client slot
+ * 
+ * Safe from any handler, including the timer handler through on_sample():
+ * BMP180Epoll drops events still pending for the removed watch, so a slot
+ * reused by a client accepted in the same batch never sees them.
+ */
+void BMP180Daemon::close_client(client_t& client)
+{
+	if (client.watch.fd < 0) { return; }
+	epoll.remove(&client.watch);
+	close(client.watch.fd);
+	client.watch.fd = -1;
+	delete client.frame;
+	client.frame = NULL;
+}
+
+/**
+ * @brief Sends reply status
+ * @param fd Client socket
+ * @param status Status to send
+ */
+void BMP180Daemon::reply(int fd, status_t status)
+{
+	uint8_t data = (uint8_t)status;
+	ssize_t n = send(fd, &data, 1, MSG_DONTWAIT | MSG_NOSIGNAL);
+	(void)n;
+}
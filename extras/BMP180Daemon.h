@@ -0,0 +1,89 @@
+/**
+ * @file BMP180Daemon.h
+ * @brief Sensor-owning daemon serving BMP180 sample subscriptions over a Unix socket
+ */
+#pragma once
+#include "BMP180Epoll.h"
+#include "../BMP180Frame.h"
+
+/**
+ * Class Declaration
+ */
+class BMP180Daemon
+{
+public:
+
+	// Subscribe request
+	typedef struct
+	{
+		uint8_t version;	// Protocol version
+		uint8_t sensor;		// Sensor index
+		uint8_t fields;		// OR of BMP180Frame::field_t flags
+		uint8_t batch;		// Samples per frame (0 treated as 1)
+		uint16_t rate_hz;	// Maximum sample rate [Hz] (0 for sensor rate)
+		uint16_t decimation;	// Keep one of every this many rate-limited samples
+	}
+	request_t;
+	static const uint8_t protocol_version = 1;
+	static const uint8_t request_len = 8;
+
+	// Reply status (1 byte)
+	typedef enum
+	{
+		status_ok = 0,		// Subscribed, frames follow
+		status_bad_request = 1,	// Malformed request, subscription unchanged
+		status_busy = 2,	// No free client slot, connection closed
+	}
+	status_t;
+
+	// Constructor and basics
+	BMP180Daemon(BMP180Scheduler** scheds, uint8_t count);
+	~BMP180Daemon();
+	bool init(const char* path);
+	void run();
+	void stop();
+	static bool decode(const uint8_t* data, uint16_t length, request_t& request);
+
+	// Counters
+	uint32_t get_frames_sent();
+	uint32_t get_frames_dropped();
+
+protected:
+
+	// Acquisition
+	BMP180Scheduler** scheds;
+	uint8_t count;
+	BMP180Loop loop;
+	BMP180Epoll epoll;
+
+	// Listening socket
+	const char* path;
+	BMP180Epoll::watch_t listen_watch;
+
+	// Clients
+	static const uint8_t max_clients = 16;
+	static const uint16_t frame_size = 1024;
+	typedef struct
+	{
+		BMP180Daemon* daemon;
+		BMP180Epoll::watch_t watch;
+		BMP180Frame* frame;
+		uint8_t sensor;
+		uint8_t batch;
+		uint8_t buffer[frame_size];
+	}
+	client_t;
+	client_t clients[max_clients];
+
+	// Counters
+	uint32_t frames_sent;
+	uint32_t frames_dropped;
+
+	static void on_listen(void* arg, int fd, uint32_t events);
+	static void on_client(void* arg, int fd, uint32_t events);
+	static void on_sample(void* arg, uint8_t index);
+	status_t subscribe(client_t& client, const uint8_t* data, uint16_t length);
+	void send_frame(client_t& client);
+	void close_client(client_t& client);
+	static void reply(int fd, status_t status);
+};
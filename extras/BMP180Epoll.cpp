@@ -0,0 +1,208 @@
+/**
+ * @file BMP180Epoll.cpp
+ */
+#include "BMP180Epoll.h"
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+/**
+ * @brief Constructs epoll driver
+ * @param loop Event loop to drive
+ * 
+ * Runs the loop on the calling thread with one timerfd, re-armed after
+ * every poll() for the earliest time any sensor has work to do. The thread
+ * sleeps in epoll_wait() between conversions, so dozens of sensors over
+ * several buses cost one thread and one wakeup per conversion step.
+ * 
+ * Other descriptors (sockets, pipes) can be watched on the same thread
+ * with add(), so their handlers never race the sensors.
+ */
+BMP180Epoll::BMP180Epoll(BMP180Loop* loop)
+{
+	this->loop = loop;
+	this->epoll_fd = -1;
+	this->timer_watch.fd = -1;
+	this->timer_watch.handler = NULL;
+	this->timer_watch.arg = NULL;
+	this->stop_watch.fd = -1;
+	this->stop_watch.handler = NULL;
+	this->stop_watch.arg = NULL;
+	this->batch_count = 0;
+}
+
+/**
+ * @brief Closes driver descriptors
+ */
+BMP180Epoll::~BMP180Epoll()
+{
+	close_fd(timer_watch.fd);
+	close_fd(stop_watch.fd);
+	close_fd(epoll_fd);
+}
+
+/**
+ * @brief Creates epoll, timer and stop descriptors
+ * @return True if all were created
+ */
+bool BMP180Epoll::init()
+{
+	epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	timer_watch.fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	stop_watch.fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (epoll_fd < 0 || timer_watch.fd < 0 || stop_watch.fd < 0)
+	{
+		return false;
+	}
+	return add(&timer_watch) && add(&stop_watch);
+}
+
+/**
+ * @brief Watches descriptor for input
+ * @param watch Descriptor and handler, must outlive the watch
+ * @return True on success
+ * 
+ * The handler runs on the run() thread with the epoll events that fired.
+ * Any handler may remove any watch, including through the loop's sample
+ * callbacks; events already fetched for a removed watch are dropped, so
+ * its slot may be reused straight away.
+ */
+bool BMP180Epoll::add(watch_t* watch)
+{
+	struct epoll_event event;
+	event.events = EPOLLIN;
+	event.data.ptr = watch;
+	return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, watch->fd, &event) == 0;
+}
+
+/**
+ * @brief Stops watching descriptor
+ * @param watch Watch passed to add()
+ * 
+ * Also drops its events still pending in the current run() batch.
+ */
+void BMP180Epoll::remove(watch_t* watch)
+{
+	epoll_ctl(epoll_fd, EPOLL_CTL_DEL, watch->fd, NULL);
+	for (uint8_t i = 0; i < batch_count; i++)
+	{
+		if (batch[i] == watch) { batch[i] = NULL; }
+	}
+}
+
+/**
+ * @brief Starts loop and services it until stop()
+ * 
+ * Returns early if epoll_wait() fails for a reason other than a signal.
+ */
+void BMP180Epoll::run()
+{
+	// Start sensors and arm first deadline
+	uint64_t value;
+	loop->start(now_us());
+	arm(loop->poll(now_us()));
+	while (true)
+	{
+		struct epoll_event events[max_events];
+		int n = epoll_wait(epoll_fd, events, max_events, -1);
+		if (n < 0)
+		{
+			if (errno == EINTR) { continue; }
+			return;
+		}
+
+		// Copy batch so remove() can drop pending events
+		for (int i = 0; i < n; i++)
+		{
+			batch[i] = (watch_t*)events[i].data.ptr;
+			batch_events[i] = events[i].events;
+		}
+		batch_count = (uint8_t)n;
+		for (uint8_t i = 0; i < batch_count; i++)
+		{
+			watch_t* watch = batch[i];
+			if (watch == NULL)
+			{
+				continue;
+			}
+			else if (watch == &timer_watch)
+			{
+				// Service sensors and re-arm
+				while (read(timer_watch.fd, &value, sizeof(value)) > 0) {}
+				arm(loop->poll(now_us()));
+			}
+			else if (watch == &stop_watch)
+			{
+				// Consume request so the next run() starts
+				while (read(stop_watch.fd, &value, sizeof(value)) > 0) {}
+				batch_count = 0;
+				return;
+			}
+			else
+			{
+				watch->handler(watch->arg, watch->fd, batch_events[i]);
+			}
+		}
+		batch_count = 0;
+	}
+}
+
+/**
+ * @brief Makes run() return
+ * 
+ * Safe from any thread and from signal handlers. A request made before
+ * run() is not lost: run() then returns after its first poll.
+ */
+void BMP180Epoll::stop()
+{
+	uint64_t value = 1;
+	ssize_t written = write(stop_watch.fd, &value, sizeof(value));
+	(void)written;
+}
+
+/**
+ * @brief Returns monotonic time [us]
+ * 
+ * Wraps every 71 minutes, which the loop and schedulers allow for.
+ */
+uint32_t BMP180Epoll::now_us()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t)((uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u);
+}
+
+/**
+ * @brief Arms timer for a loop deadline
+ * @param next_us Time returned by BMP180Loop::poll() [us]
+ * 
+ * Times already passed fire as soon as possible; a zero it_value would
+ * disarm the timer instead.
+ */
+void BMP180Epoll::arm(uint32_t next_us)
+{
+	int32_t wait_us = (int32_t)(next_us - now_us());
+	if (wait_us < 1) { wait_us = 1; }
+	struct itimerspec spec;
+	spec.it_interval.tv_sec = 0;
+	spec.it_interval.tv_nsec = 0;
+	spec.it_value.tv_sec = wait_us / 1000000;
+	spec.it_value.tv_nsec = (wait_us % 1000000) * 1000;
+	timerfd_settime(timer_watch.fd, 0, &spec, NULL);
+}
+
+/**
+ * @brief Closes descriptor if open
+ * @param fd Descriptor, set to -1
+ */
+void BMP180Epoll::close_fd(int& fd)
+{
+	if (fd >= 0)
+	{
+		close(fd);
+		fd = -1;
+	}
+}
@@ -0,0 +1,57 @@
+/**
+ * @file BMP180Epoll.h
+ * @brief Linux epoll and timerfd driver for BMP180Loop
+ */
+#pragma once
+#include "../BMP180Loop.h"
+
+/**
+ * Class Declaration
+ */
+class BMP180Epoll
+{
+public:
+
+	// Descriptor callback (context, descriptor, epoll events)
+	typedef void (*handler_t)(void* arg, int fd, uint32_t events);
+
+	// Watched descriptor (owned by caller)
+	typedef struct
+	{
+		int fd;
+		handler_t handler;
+		void* arg;
+	}
+	watch_t;
+
+	// Constructor and basics
+	BMP180Epoll(BMP180Loop* loop);
+	~BMP180Epoll();
+	bool init();
+	bool add(watch_t* watch);
+	void remove(watch_t* watch);
+	void run();
+	void stop();
+
+	// Clock
+	static uint32_t now_us();
+
+protected:
+
+	// Event loop
+	BMP180Loop* loop;
+	static const uint8_t max_events = 16;
+
+	// Descriptors
+	int epoll_fd;
+	watch_t timer_watch;
+	watch_t stop_watch;
+
+	// Events of current epoll_wait() batch (removed watches set to NULL)
+	watch_t* batch[max_events];
+	uint32_t batch_events[max_events];
+	uint8_t batch_count;
+
+	void arm(uint32_t next_us);
+	static void close_fd(int& fd);
+};
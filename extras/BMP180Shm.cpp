@@ -0,0 +1,141 @@
+/**
+ * @file BMP180Shm.cpp
+ */
+#include "BMP180Shm.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * @brief Constructs unmapped segment
+ * 
+ * Maps a named POSIX shared-memory object (/dev/shm on Linux) and wraps it
+ * in a BMP180Ring. The publishing process calls create(), which sizes the
+ * object and initializes the ring; each reading process calls open() and
+ * reads the same memory with no further syscalls.
+ * 
+ * Build on a Linux host with the driver dependencies on the include path,
+ * adding the program that publishes or reads, e.g.:
+ * g++ -O2 -std=c++11 -I<deps> main.cpp extras/BMP180Shm.cpp BMP180Ring.cpp
+ *     -o bmp180_reader
+ * (glibc before 2.34 also needs -lrt for shm_open()).
+ */
+BMP180Shm::BMP180Shm()
+{
+	this->memory = NULL;
+	this->bytes = 0;
+	this->ring = NULL;
+}
+
+/**
+ * @brief Unmaps segment (the named object stays until remove())
+ */
+BMP180Shm::~BMP180Shm()
+{
+	close();
+}
+
+/**
+ * @brief Creates or reuses segment and initializes ring (publisher)
+ * @param name Object name starting with '/', e.g. "/bmp180"
+ * @param size Number of ring slots (power of 2)
+ * @return True on success
+ * 
+ * An existing object of the same name is resized and re-initialized,
+ * which is what a restarted publisher does. See BMP180Ring::read_next()
+ * for what attached readers see then.
+ */
+bool BMP180Shm::create(const char* name, uint16_t size)
+{
+	close();
+	int fd = shm_open(name, O_CREAT | O_RDWR | O_CLOEXEC, 0644);
+	if (fd < 0) { return false; }
+	bool ok = ftruncate(fd, BMP180Ring::get_bytes(size)) == 0 && map(fd, size, true);
+	::close(fd);
+	if (!ok) { return false; }
+	ring->init();
+	return true;
+}
+
+/**
+ * @brief Maps existing segment read-only and attaches ring (reader)
+ * @param name Object name passed to create()
+ * @param size Number of ring slots, as passed to create()
+ * @return False if the object is missing, too small or not initialized
+ * 
+ * Readers never write the shared memory (the cursor and lost count are
+ * local), so the mapping is PROT_READ and a reader cannot corrupt it.
+ */
+bool BMP180Shm::open(const char* name, uint16_t size)
+{
+	close();
+	int fd = shm_open(name, O_RDONLY | O_CLOEXEC, 0);
+	if (fd < 0) { return false; }
+	struct stat st;
+	bool ok = fstat(fd, &st) == 0 &&
+		(uint64_t)st.st_size >= BMP180Ring::get_bytes(size) &&
+		map(fd, size, false);
+	::close(fd);
+	if (!ok) { return false; }
+	if (!ring->attach())
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Unmaps segment
+ */
+void BMP180Shm::close()
+{
+	delete ring;
+	ring = NULL;
+	if (memory != NULL)
+	{
+		munmap(memory, bytes);
+		memory = NULL;
+		bytes = 0;
+	}
+}
+
+/**
+ * @brief Returns ring over mapped segment, or NULL if none is mapped
+ */
+BMP180Ring* BMP180Shm::get_ring()
+{
+	return ring;
+}
+
+/**
+ * @brief Removes named object
+ * @param name Object name passed to create()
+ * @return True on success
+ * 
+ * Processes that still map it keep their memory until they close().
+ */
+bool BMP180Shm::remove(const char* name)
+{
+	return shm_unlink(name) == 0;
+}
+
+/**
+ * @brief Maps open object and builds ring view
+ * @param fd Object descriptor (may be closed afterwards)
+ * @param size Number of ring slots
+ * @param writable True to map for writing
+ * @return True on success
+ */
+bool BMP180Shm::map(int fd, uint16_t size, bool writable)
+{
+	size_t length = BMP180Ring::get_bytes(size);
+	int prot = writable ? (PROT_READ | PROT_WRITE) : PROT_READ;
+	void* addr = mmap(NULL, length, prot, MAP_SHARED, fd, 0);
+	if (addr == MAP_FAILED) { return false; }
+	memory = addr;
+	bytes = length;
+	ring = new BMP180Ring(memory, size);
+	return true;
+}
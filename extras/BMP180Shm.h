@@ -0,0 +1,33 @@
+/**
+ * @file BMP180Shm.h
+ * @brief Linux POSIX shared-memory segment for BMP180Ring
+ */
+#pragma once
+#include "../BMP180Ring.h"
+#include <stddef.h>
+
+/**
+ * Class Declaration
+ */
+class BMP180Shm
+{
+public:
+
+	// Constructor and basics
+	BMP180Shm();
+	~BMP180Shm();
+	bool create(const char* name, uint16_t size);
+	bool open(const char* name, uint16_t size);
+	void close();
+	BMP180Ring* get_ring();
+	static bool remove(const char* name);
+
+protected:
+
+	// Mapping
+	void* memory;
+	size_t bytes;
+	BMP180Ring* ring;
+
+	bool map(int fd, uint16_t size, bool writable);
+};
@@ -0,0 +1,126 @@
+/**
+ * @file BMP180Sim.cpp
+ */
+#include "BMP180Sim.h"
+#include <math.h>
+
+/**
+ * Datasheet RMS Pressure Noise per Oversampling Setting [Pa]
+ */
+static const float noise_rms_pa[4] = { 6.0f, 5.0f, 4.0f, 3.0f };
+
+/**
+ * @brief Constructs simulator for one sensor
+ * @param cal Calibration coefficients (e.g. from BMP180::get_cal())
+ * 
+ * Defaults to the standard atmosphere, a stationary trajectory at sea
+ * level, and no noise.
+ */
+BMP180Sim::BMP180Sim(const BMP180::cal_t& cal)
+{
+	this->cal = cal;
+	this->rand_state = 0x12345678;
+	set_atmosphere();
+	set_trajectory(0.0f);
+	set_noise(false);
+}
+
+/**
+ * @brief Sets atmosphere model
+ * @param sea_level_p Sea-level pressure [kPa]
+ * @param sea_level_t Sea-level temperature [deg C]
+ * 
+ * Uses the standard troposphere with a 6.5 K/km lapse rate. Generated
+ * temperatures can go as cold as the UT code range of the calibration
+ * allows (below -75 deg C for the datasheet example), which covers the
+ * -40 deg C rating of the sensor.
+ */
+void BMP180Sim::set_atmosphere(float sea_level_p, float sea_level_t)
+{
+	this->sea_level_p = sea_level_p;
+	this->sea_level_t = sea_level_t;
+}
+
+/**
+ * @brief Sets altitude trajectory alt + climb * t + amp * sin(2 pi t / period)
+ * @param alt Initial altitude [m]
+ * @param climb Climb rate [m/s]
+ * @param amp Oscillation amplitude [m]
+ * @param period Oscillation period [s]
+ */
+void BMP180Sim::set_trajectory(float alt, float climb, float amp, float period)
+{
+	this->alt = alt;
+	this->climb = climb;
+	this->amp = amp;
+	this->period = period;
+}
+
+/**
+ * @brief Enables datasheet-level pressure noise
+ * @param noise True to add noise
+ */
+void BMP180Sim::set_noise(bool noise)
+{
+	this->noise = noise;
+}
+
+/**
+ * @brief Generates raw readings along the trajectory
+ * @param time Trajectory time [s]
+ * @param oss Oversampling setting (0-3)
+ * @param ut Output uncompensated temperature
+ * @param up Output uncompensated pressure
+ */
+void BMP180Sim::sample(float time, uint8_t oss, int32_t& ut, uint32_t& up)
+{
+	float h = alt + climb * time;
+	if (amp != 0.0f)
+	{
+		h += amp * sinf(6.2831853f * time / period);
+	}
+	sample_alt(h, oss, ut, up);
+}
+
+/**
+ * @brief Generates raw readings at an altitude
+ * @param alt Altitude above sea level [m]
+ * @param oss Oversampling setting (0-3)
+ * @param ut Output uncompensated temperature
+ * @param up Output uncompensated pressure
+ */
+void BMP180Sim::sample_alt(float alt, uint8_t oss, int32_t& ut, uint32_t& up)
+{
+	// Standard troposphere
+	float t0_k = sea_level_t + 273.15f;
+	float t_k = t0_k - 0.0065f * alt;
+	float p_pa = sea_level_p * 1000.0f * powf(t_k / t0_k, 5.25588f);
+	if (noise)
+	{
+		p_pa += noise_pa(oss);
+	}
+
+	// Invert compensation
+	ut = BMP180::inv_temp(cal, (int32_t)lroundf((t_k - 273.15f) * 10.0f));
+	int32_t b5 = BMP180::comp_b5(cal, ut);
+	up = BMP180::inv_pres(cal, b5, (int32_t)lroundf(p_pa), oss);
+}
+
+/**
+ * @brief Returns approximately Gaussian pressure noise [Pa]
+ * @param oss Oversampling setting (0-3)
+ * 
+ * Sum of four uniform xorshift32 draws, scaled to the datasheet RMS.
+ */
+float BMP180Sim::noise_pa(uint8_t oss)
+{
+	float sum = 0.0f;
+	for (uint8_t i = 0; i < 4; i++)
+	{
+		rand_state ^= rand_state << 13;
+		rand_state ^= rand_state >> 17;
+		rand_state ^= rand_state << 5;
+		sum += rand_state * (1.0f / 4294967296.0f) - 0.5f;
+	}
+	return sum * 1.7320508f * noise_rms_pa[oss];
+}
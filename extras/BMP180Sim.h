@@ -0,0 +1,44 @@
+/**
+ * @file BMP180Sim.h
+ * @brief Physics-driven generator of raw BMP180 readings
+ */
+#pragma once
+#include "../BMP180.h"
+
+/**
+ * Class Declaration
+ */
+class BMP180Sim
+{
+public:
+
+	// Constructor and basics
+	BMP180Sim(const BMP180::cal_t& cal);
+	void set_atmosphere(float sea_level_p = 101.325f, float sea_level_t = 15.0f);
+	void set_trajectory(float alt, float climb = 0.0f, float amp = 0.0f, float period = 1.0f);
+	void set_noise(bool noise);
+
+	// Raw reading generation
+	void sample(float time, uint8_t oss, int32_t& ut, uint32_t& up);
+	void sample_alt(float alt, uint8_t oss, int32_t& ut, uint32_t& up);
+
+protected:
+
+	// Calibration
+	BMP180::cal_t cal;
+
+	// Atmosphere model
+	float sea_level_p;
+	float sea_level_t;
+
+	// Trajectory model
+	float alt;
+	float climb;
+	float amp;
+	float period;
+
+	// Noise generator
+	bool noise;
+	uint32_t rand_state;
+	float noise_pa(uint8_t oss);
+};